@@ -0,0 +1,262 @@
+// 练习引擎基准测试
+// 用脚本化的按键流驱动TypingSession和SessionView（与practiceSession的输入循环相同：
+// 一轮按键逐个更新状态后只渲染一次），屏幕输出写入临时文件而不是真实终端。
+// 报告每次按键的耗时、内存分配次数和输出到终端的字节数。
+//
+// 编译（在项目根目录）：
+//   g++ -std=c++17 -O2 bench/session_bench.cpp src/typing_session.cpp src/session_view.cpp
+//       src/typing_analysis.cpp src/typing_score.cpp src/live_stats.cpp src/keystroke_log.cpp
+//       src/utf8_text.cpp src/gui_helper.cpp -I includes -I src ... -o bin/session_bench
+// 用法：
+//   session_bench [--max-keys N] [--unicode] [文本大小KB ...]
+//   --unicode 使用中文和带重音的拉丁文单词，用于与ASCII文本的每键开销对比
+
+#include <chrono>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <curses.h>
+#include "typing_session.h"
+#include "session_view.h"
+#include "gui_helper.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// --- 内存分配计数 ---
+static size_t allocCount = 0;
+static size_t allocBytes = 0;
+
+void* operator new(size_t size)
+{
+    allocCount++;
+    allocBytes += size;
+    void* p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+// 按键流场景
+enum Scenario
+{
+    SCENARIO_PERFECT,  // 全部输入正确，每个按键渲染一次
+    SCENARIO_ERRORS,   // 5%的按键输错后退格改正，每个按键渲染一次
+    SCENARIO_PASTE     // 整段粘贴，每256个按键渲染一次
+};
+
+static const char* scenarioName(Scenario scenario)
+{
+    switch (scenario)
+    {
+    case SCENARIO_PERFECT:
+        return "perfect";
+    case SCENARIO_ERRORS:
+        return "5%-errors";
+    default:
+        return "paste";
+    }
+}
+
+// 生成指定大小（UTF-8字节数）的练习文本
+static string makeText(size_t bytes, bool unicode, mt19937& gen)
+{
+    static const char* WORDS[] = {
+        "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "practice", "keyboard",
+        "typing", "speed", "accuracy", "session", "window", "render", "latency", "buffer", "Hello,", "world."};
+    static const char* UNICODE_WORDS[] = {
+        "打字", "练习", "速度", "准确率", "键盘", "café", "naïve", "über", "señor", "Ærø",
+        "中文输入", "渲染", "延迟", "缓冲区", "résumé", "façade", "窗口", "会话", "Grüße", "测试"};
+    const char** words = unicode ? UNICODE_WORDS : WORDS;
+    uniform_int_distribution<> pick(0, 19);
+
+    string text;
+    text.reserve(bytes + 16);
+    while (text.size() < bytes)
+    {
+        text += words[pick(gen)];
+        text += ' ';
+    }
+
+    // 截断时不能切在多字节字符中间
+    size_t cut = bytes;
+    while (cut > 0 && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80)
+    {
+        cut--;
+    }
+    text.resize(cut);
+    return text;
+}
+
+// 单次测试结果
+struct BenchResult
+{
+    double setupMs = 0;
+    size_t setupBytes = 0;
+    size_t keys = 0;
+    double nsPerKey = 0;
+    double allocsPerKey = 0;
+    double renderBytesPerKey = 0;
+};
+
+static BenchResult runBench(const string& text, Scenario scenario, size_t maxKeys, WINDOW* win, FILE* screenOut)
+{
+    BenchResult result;
+    mt19937 gen(42);
+    uniform_int_distribution<> percent(0, 99);
+
+    // 练习开始：文本载入、断行和首次绘制
+    size_t allocBefore = allocBytes;
+    auto setupStart = steady_clock::now();
+    auto keyTime = setupStart;
+
+    TypingSession session;
+    session.start(text, false, false, keyTime);
+    SessionView view(win, 4, 2);
+    view.layout(session, getmaxx(win) - 6);
+    view.drawAll(session);
+    session.clearDirty();
+    view.refresh();
+
+    result.setupMs = duration_cast<microseconds>(steady_clock::now() - setupStart).count() / 1000.0;
+    result.setupBytes = allocBytes - allocBefore;
+
+    fflush(screenOut);
+    long screenBefore = ftell(screenOut);
+    size_t allocsBefore = allocCount;
+    size_t burst = (scenario == SCENARIO_PASTE) ? 256 : 1;
+    size_t keys = 0;
+
+    auto start = steady_clock::now();
+    while (!session.isFinished() && keys < maxKeys)
+    {
+        for (size_t b = 0; b < burst && !session.isFinished() && keys < maxKeys; b++)
+        {
+            // 按键时间戳只用于统计，按每分钟600键递增，不实际等待
+            keyTime += milliseconds(100);
+            char32_t expected = session.getText()[session.getPosition()];
+
+            if (scenario == SCENARIO_ERRORS && percent(gen) < 5)
+            {
+                session.typeChar(expected == U'x' ? U'y' : U'x', keyTime);
+                session.backspace(keyTime);
+                keys += 2;
+            }
+            session.typeChar(expected, keyTime);
+            keys++;
+        }
+
+        view.drawDirty(session);
+        session.clearDirty();
+        view.refresh();
+    }
+    auto elapsed = steady_clock::now() - start;
+
+    fflush(screenOut);
+    long screenAfter = ftell(screenOut);
+
+    result.keys = keys;
+    if (keys > 0)
+    {
+        result.nsPerKey = static_cast<double>(duration_cast<nanoseconds>(elapsed).count()) / keys;
+        result.allocsPerKey = static_cast<double>(allocCount - allocsBefore) / keys;
+        result.renderBytesPerKey = static_cast<double>(screenAfter - screenBefore) / keys;
+    }
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t maxKeys = 200000;
+    bool unicode = false;
+    vector<size_t> sizesKB;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--max-keys" && i + 1 < argc)
+        {
+            maxKeys = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--unicode")
+        {
+            unicode = true;
+        }
+        else
+        {
+            sizesKB.push_back(strtoul(argv[i], nullptr, 10));
+        }
+    }
+
+    if (sizesKB.empty())
+    {
+        sizesKB = {1, 64, 1024, 10240};
+    }
+
+    setlocale(LC_ALL, "");
+
+    // 虚拟屏幕：输出写入临时文件（PDCurses会忽略这两个参数并使用控制台，此时输出字节数为0）
+    FILE* screenOut = tmpfile();
+    FILE* screenIn = tmpfile();
+    if (!screenOut || !screenIn)
+    {
+        fprintf(stderr, "Unable to create virtual screen files\n");
+        return 1;
+    }
+
+    SCREEN* screen = newterm("xterm", screenOut, screenIn);
+    if (!screen)
+    {
+        fprintf(stderr, "Unable to create virtual screen\n");
+        return 1;
+    }
+    set_term(screen);
+    resize_term(24, 80);
+    GUIHelper::initColors();
+    WINDOW* win = newwin(18, 80, 3, 0);
+
+    vector<string> report;
+    mt19937 gen(1);
+    for (size_t kb : sizesKB)
+    {
+        string text = makeText(kb * 1024, unicode, gen);
+        for (Scenario scenario : {SCENARIO_PERFECT, SCENARIO_ERRORS, SCENARIO_PASTE})
+        {
+            BenchResult r = runBench(text, scenario, maxKeys, win, screenOut);
+
+            char line[200];
+            snprintf(line, sizeof(line), "%8zuKB %-10s %9zu %10.0f %10.3f %10.1f %10.2f %9.1f",
+                     kb, scenarioName(scenario), r.keys, r.nsPerKey, r.allocsPerKey,
+                     r.renderBytesPerKey, r.setupMs, r.setupBytes / 1048576.0);
+            report.push_back(line);
+        }
+    }
+
+    delwin(win);
+    endwin();
+    delscreen(screen);
+
+    printf("%10s %-10s %9s %10s %10s %10s %10s %9s\n",
+           "text", "scenario", "keys", "ns/key", "allocs/key", "bytes/key", "setup ms", "setup MB");
+    for (const string& line : report)
+    {
+        printf("%s\n", line.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "async_file_writer.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// 析构函数
+AsyncFileWriter::~AsyncFileWriter()
+{
+    stop();
+}
+
+// 替换文件
+void AsyncFileWriter::replace(const string& path, string content)
+{
+    lock_guard<mutex> lock(queueMutex);
+
+    // 同一文件还在排队的旧内容直接替换，只写最新的一份
+    for (Job& job : jobs)
+    {
+        if (!job.task && job.path == path)
+        {
+            job.content = move(content);
+            return;
+        }
+    }
+
+    Job job;
+    job.path = path;
+    job.content = move(content);
+    enqueue(move(job));
+}
+
+// 提交写入任务
+void AsyncFileWriter::post(const string& path, function<bool()> task)
+{
+    lock_guard<mutex> lock(queueMutex);
+    Job job;
+    job.path = path;
+    job.task = move(task);
+    enqueue(move(job));
+}
+
+// 加入请求
+void AsyncFileWriter::enqueue(Job job)
+{
+    jobs.push_back(move(job));
+    if (!worker.joinable())
+    {
+        stopping = false;
+        worker = thread(&AsyncFileWriter::run, this);
+    }
+    wake.notify_one();
+}
+
+// 等待所有请求写完
+bool AsyncFileWriter::flush(string* error)
+{
+    unique_lock<mutex> lock(queueMutex);
+    idle.wait(lock, [this]() { return jobs.empty() && !busy; });
+    if (!failed)
+    {
+        return true;
+    }
+    if (error != nullptr)
+    {
+        *error = lastError;
+    }
+    failed = false;
+    return false;
+}
+
+// 取出失败原因
+bool AsyncFileWriter::takeError(string& error)
+{
+    lock_guard<mutex> lock(queueMutex);
+    if (!failed)
+    {
+        return false;
+    }
+    error = lastError;
+    failed = false;
+    return true;
+}
+
+// 停止后台线程
+void AsyncFileWriter::stop()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+// 后台线程主循环：逐个执行请求，停止前写完队列
+void AsyncFileWriter::run()
+{
+    unique_lock<mutex> lock(queueMutex);
+    while (true)
+    {
+        wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+        {
+            break;
+        }
+
+        Job job = move(jobs.front());
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+
+        errno = 0;
+        bool written = job.task ? job.task() : writeAtomically(job.path, job.content);
+        int code = errno;
+
+        lock.lock();
+        if (!written)
+        {
+            // 只保留最后一次失败，由flush或takeError交给调用者
+            failed = true;
+            lastError = "unable to write " + job.path + (code != 0 ? string(": ") + strerror(code) : string());
+        }
+        busy = false;
+        if (jobs.empty())
+        {
+            idle.notify_all();
+        }
+    }
+}
+
+// 原子地替换文件
+bool AsyncFileWriter::writeAtomically(const string& path, const string& content)
+{
+    string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    // 内容先完整落盘，再用重命名替换，崩溃时目标文件不会只写了一半
+    bool written = fwrite(content.data(), 1, content.size(), file) == content.size() && fflush(file) == 0;
+#ifdef _WIN32
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    written = (fclose(file) == 0) && written;
+    if (!written)
+    {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+#ifdef _WIN32
+    if (!MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        remove(tempPath.c_str());
+        return false;
+    }
+#else
+    if (rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    // 同步目录，保证重命名本身也已落盘
+    size_t separator = path.find_last_of('/');
+    string directory = (separator == string::npos) ? "." : path.substr(0, separator + 1);
+    int directoryFd = open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (directoryFd >= 0)
+    {
+        fsync(directoryFd);
+        close(directoryFd);
+    }
+#endif
+    return true;
+}
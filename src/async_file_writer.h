@@ -0,0 +1,68 @@
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 后台文件写入线程
+// 界面线程只把要写的内容放入队列，写盘、fsync和重命名都在后台线程中进行。
+// 替换整个文件的请求按路径合并：同一文件尚未写出的旧内容直接被新内容覆盖，
+// 连续多次保存只写最后一次。析构或stop时先写完队列中的所有请求再退出
+class AsyncFileWriter
+{
+public:
+    AsyncFileWriter() = default;
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    // 用content原子地替换path（首次调用时启动后台线程）
+    void replace(const std::string& path, std::string content);
+
+    // 提交一个按顺序执行的写入任务（例如向历史文件追加记录），task返回false表示写入path失败
+    void post(const std::string& path, std::function<bool()> task);
+
+    // 等待所有已提交的请求写完；上次检查之后有请求失败时返回false，error为最后一次失败的原因
+    bool flush(std::string* error = nullptr);
+
+    // 不等待，取出上次检查之后最后一次失败的原因；没有失败时返回false
+    bool takeError(std::string& error);
+
+    // 写完所有请求后停止后台线程
+    void stop();
+
+    // 写入临时文件、fsync后重命名为path，任何时刻path都是完整的旧内容或新内容
+    static bool writeAtomically(const std::string& path, const std::string& content);
+
+private:
+    // 一个写入请求：task为空时表示替换文件
+    struct Job
+    {
+        std::string path;
+        std::string content;
+        std::function<bool()> task;
+    };
+
+    // 加入请求并在需要时启动后台线程（调用者持有锁）
+    void enqueue(Job job);
+
+    // 后台线程主循环
+    void run();
+
+    std::mutex queueMutex;
+    std::condition_variable wake;   // 有新请求或需要停止
+    std::condition_variable idle;   // 队列已写空
+    std::deque<Job> jobs;
+    bool busy = false;              // 后台线程正在执行一个请求
+    bool stopping = false;
+    bool failed = false;            // 上次检查之后有请求失败
+    std::string lastError;
+    std::thread worker;
+};
+
+#endif // ASYNC_FILE_WRITER_H
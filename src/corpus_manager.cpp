@@ -431,6 +431,11 @@ Corpus CorpusManager::selectCorpus(WINDOW *headerWin, WINDOW *contentWin, WINDOW
         int ch = wgetch(contentWin);
         switch (ch)
         {
+        case KEY_RESIZE:
+            // 终端大小改变，下一轮按新尺寸重绘
+            GUIHelper::resizeWindows(headerWin, contentWin, statusWin);
+            break;
+
         case KEY_UP:
             if (selectedIndex > 0)
             {
@@ -967,6 +972,11 @@ void CorpusManager::deleteCorpus(WINDOW *headerWin, WINDOW *contentWin, WINDOW *
         int ch = wgetch(contentWin);
         switch (ch)
         {
+        case KEY_RESIZE:
+            // 终端大小改变，下一轮按新尺寸重绘
+            GUIHelper::resizeWindows(headerWin, contentWin, statusWin);
+            break;
+
         case KEY_UP:
             if (selectedIndex > 0)
             {
@@ -5,6 +5,13 @@ using namespace std;
 
 namespace GUIHelper {
 
+namespace {
+    // 标题栏和状态栏最近一次显示的内容，终端大小改变后按原样重绘
+    string lastTitle;
+    string lastStatus;
+    string lastHelp;
+}
+
 // 初始化窗口
 void initWindows(WINDOW** headerWin, WINDOW** contentWin, WINDOW** statusWin) {
     // 获取终端尺寸
@@ -30,6 +37,33 @@ void initWindows(WINDOW** headerWin, WINDOW** contentWin, WINDOW** statusWin) {
     wrefresh(*statusWin);
 }
 
+// 终端大小改变：原地调整三个窗口的大小和位置
+void resizeWindows(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin) {
+#ifdef PDCURSES
+    // PDCurses不会自动更新屏幕尺寸
+    resize_term(0, 0);
+#endif
+    int maxY, maxX;
+    getmaxyx(stdscr, maxY, maxX);
+
+    // 内容窗口至少保留边框和一行文字；先调整大小再移动，缩小时窗口不会越界
+    int contentHeight = max(maxY - 6, 3);
+    wresize(headerWin, 3, maxX);
+    wresize(contentWin, contentHeight, maxX);
+    wresize(statusWin, 3, maxX);
+    mvwin(headerWin, 0, 0);
+    mvwin(contentWin, 3, 0);
+    mvwin(statusWin, 3 + contentHeight, 0);
+
+    // 清除屏幕上残留的旧内容
+    werase(stdscr);
+    wnoutrefresh(stdscr);
+
+    updateHeaderWindow(headerWin, lastTitle);
+    updateStatusWindowWithHelp(statusWin, lastStatus, lastHelp);
+    clearContentWindow(contentWin);
+}
+
 // 初始化颜色
 void initColors()
 {
@@ -44,6 +78,7 @@ void initColors()
     init_pair(COLOR_STATS, COLOR_CYAN, COLOR_BLACK);           // 统计信息为青字
     init_pair(COLOR_HEADER, COLOR_BLACK, COLOR_WHITE);         // 标题栏为黑字白底
     init_pair(COLOR_GUIDE, COLOR_CYAN, COLOR_BLACK);           // 导引文字为青色黑底
+    init_pair(COLOR_GHOST, COLOR_BLACK, COLOR_MAGENTA);        // 幽灵光标为黑字品红底
 }
 
 // 绘制边框
@@ -72,6 +107,7 @@ void drawBox(WINDOW* win) {
 
 // 更新标题窗口
 void updateHeaderWindow(WINDOW* win, const string& title) {
+    lastTitle = title;
     werase(win);
     drawBox(win);
     wattron(win, COLOR_PAIR(COLOR_HEADER));
@@ -82,6 +118,8 @@ void updateHeaderWindow(WINDOW* win, const string& title) {
 
 // 更新状态窗口
 void updateStatusWindow(WINDOW* win, const string& status) {
+    lastStatus = status;
+    lastHelp.clear();
     werase(win);
     drawBox(win);
     wattron(win, COLOR_PAIR(COLOR_STATS));
@@ -92,6 +130,8 @@ void updateStatusWindow(WINDOW* win, const string& status) {
 
 // 更新状态栏，添加返回提示
 void updateStatusWindowWithHelp(WINDOW* win, const string& status, const string& help) {
+    lastStatus = status;
+    lastHelp = help;
     werase(win);
     drawBox(win);
     wattron(win, COLOR_PAIR(COLOR_STATS));
@@ -258,6 +298,57 @@ void showMessageDialog(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin,
     wrefresh(statusWin);
 }
 
+// 读取一个宽字符按键，wchar_t为16位时合并代理对
+static bool readWideKey(KeyEvent& event) {
+    wint_t wch;
+    int result = get_wch(&wch);
+    if (result == ERR) {
+        return false;
+    }
+
+    event.isKeyCode = (result == KEY_CODE_YES);
+    event.key = static_cast<int>(wch);
+
+    if (!event.isKeyCode && wch >= 0xD800 && wch <= 0xDBFF) {
+        wint_t low;
+        if (get_wch(&low) == OK && low >= 0xDC00 && low <= 0xDFFF) {
+            event.key = 0x10000 + ((static_cast<int>(wch) - 0xD800) << 10) + (static_cast<int>(low) - 0xDC00);
+        }
+    }
+
+    event.time = chrono::steady_clock::now();
+    return true;
+}
+
+// 读取一批按键
+int readKeyBurst(KeyEvent* events, int maxEvents, int timeoutMs) {
+    // 等待第一个按键
+    timeout(timeoutMs);
+    if (!readWideKey(events[0])) {
+        timeout(-1);
+        return 0;
+    }
+    int count = 1;
+
+    // 快速输入或粘贴时，剩余按键已在输入队列中，一次性取出
+    nodelay(stdscr, TRUE);
+    while (count < maxEvents && readWideKey(events[count])) {
+        count++;
+    }
+    timeout(-1);
+
+    return count;
+}
+
+// 将按键放回输入队列
+void unreadKey(const KeyEvent& event) {
+    if (event.isKeyCode || event.key < 0x80) {
+        ungetch(event.key);
+    } else {
+        unget_wch(static_cast<wchar_t>(event.key));
+    }
+}
+
 // 程序结束清理
 void cleanup(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin) {
     // 删除窗口
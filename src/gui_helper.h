@@ -2,6 +2,7 @@
 #define GUI_HELPER_H
 
 #include <string>
+#include <chrono>
 #include <curses.h>
 
 namespace GUIHelper {
@@ -23,14 +24,27 @@ namespace GUIHelper {
     const int COLOR_STATS = 5;
     const int COLOR_HEADER = 6;
     const int COLOR_GUIDE = 7;  // 用于导引文字的颜色
+    const int COLOR_GHOST = 8;  // 幽灵光标（个人最佳成绩的回放位置）
 
     // 按键定义（改为常量而非宏定义）
     const int KEY_ESC = 27;
     const int KEY_RETURN = '\n';
     const int KEY_BACKSPACE_ALT = 8;
 
+    // 按键事件：按键码及其被读取时的时间戳
+    // isKeyCode为true时key是功能键（KEY_F(1)、KEY_BACKSPACE等），否则key是字符的Unicode码位
+    struct KeyEvent {
+        int key;
+        bool isKeyCode;
+        std::chrono::steady_clock::time_point time;
+    };
+
     // 初始化窗口
     void initWindows(WINDOW** headerWin, WINDOW** contentWin, WINDOW** statusWin);
+
+    // 终端大小改变（读到KEY_RESIZE）后按新尺寸调整三个窗口；窗口对象不变，各界面持有的指针仍然有效。
+    // 标题栏和状态栏按最近一次的内容重绘，内容窗口被清空，由调用方重绘
+    void resizeWindows(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin);
     
     // 初始化颜色
     void initColors();
@@ -58,6 +72,15 @@ namespace GUIHelper {
     void showMessageDialog(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin,
                           const std::string& message, DialogType type, const std::string& title);
     
+    // 读取一批按键：等待第一个按键，再以非阻塞方式取出所有已到达的按键
+    // 通过get_wch读取，非ASCII字符（包括输入法提交的汉字）以完整码位返回
+    // timeoutMs 为等待第一个按键的最长时间（负数表示一直等待）
+    // 返回读取到的按键数量（超时返回0，最多为maxEvents）
+    int readKeyBurst(KeyEvent* events, int maxEvents, int timeoutMs = -1);
+
+    // 将按键放回输入队列（与readKeyBurst对应）
+    void unreadKey(const KeyEvent& event);
+    
     // 程序结束清理
     void cleanup(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin);
 }
@@ -0,0 +1,177 @@
+#include "history_index.h"
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+// 记录是否满足全部条件
+bool HistoryQuery::matches(const SessionRecord& record) const
+{
+    return record.timestamp >= from && record.timestamp < to &&
+           (mode == HISTORY_ANY || record.mode == mode) &&
+           (difficulty == HISTORY_ANY || record.difficulty == difficulty) &&
+           (corpusId == HISTORY_ANY || record.corpusId == corpusId);
+}
+
+// 清空索引
+void HistoryIndex::clear()
+{
+    indexedCount = 0;
+    lastTimestamp = numeric_limits<int64_t>::min();
+    order.clear();
+    byMode.clear();
+    byDifficulty.clear();
+    byCorpus.clear();
+}
+
+// 加入新追加的记录
+void HistoryIndex::refresh()
+{
+    const SessionRecord* records = history.records();
+    size_t count = history.size();
+    if (count < indexedCount)
+    {
+        // 文件变短，说明已经不是建立索引时的文件
+        rebuild();
+        return;
+    }
+
+    // 新记录不早于已索引的最后一条时直接接在时间顺序末尾
+    for (size_t i = indexedCount; i < count; i++)
+    {
+        if (records[i].timestamp < lastTimestamp)
+        {
+            rebuild();
+            return;
+        }
+        lastTimestamp = records[i].timestamp;
+        if (!order.empty())
+        {
+            order.push_back(static_cast<uint32_t>(i));
+        }
+        addPosition(static_cast<uint32_t>(indexedCount), records[i]);
+        indexedCount++;
+    }
+}
+
+// 重建全部索引
+void HistoryIndex::rebuild()
+{
+    clear();
+
+    const SessionRecord* records = history.records();
+    size_t count = history.size();
+    if (count == 0)
+    {
+        return;
+    }
+
+    // 记录无序时按时间稳定排序，同一时间的记录保持追加顺序
+    bool sorted = is_sorted(records, records + count, [](const SessionRecord& a, const SessionRecord& b)
+    {
+        return a.timestamp < b.timestamp;
+    });
+    if (!sorted)
+    {
+        order.resize(count);
+        iota(order.begin(), order.end(), 0u);
+        stable_sort(order.begin(), order.end(), [records](uint32_t a, uint32_t b)
+        {
+            return records[a].timestamp < records[b].timestamp;
+        });
+    }
+
+    for (size_t position = 0; position < count; position++)
+    {
+        addPosition(static_cast<uint32_t>(position), recordAt(position));
+    }
+    indexedCount = count;
+    lastTimestamp = recordAt(count - 1).timestamp;
+}
+
+// 加入各个位置列表
+void HistoryIndex::addPosition(uint32_t position, const SessionRecord& record)
+{
+    byMode[record.mode].push_back(position);
+    byDifficulty[record.difficulty].push_back(position);
+    byCorpus[record.corpusId].push_back(position);
+}
+
+// 第一个时间不早于timestamp的位置
+size_t HistoryIndex::lowerBound(int64_t timestamp) const
+{
+    size_t low = 0;
+    size_t high = indexedCount;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (recordAt(middle).timestamp < timestamp)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// 汇总满足条件的记录
+HistorySummary HistoryIndex::summarize(const HistoryQuery& query) const
+{
+    HistorySummaryBuilder builder;
+    if (history.size() < indexedCount)
+    {
+        // 历史已关闭或换了文件，索引需要先refresh
+        return builder.finish();
+    }
+
+    size_t first = lowerBound(query.from);
+    size_t last = (query.to == numeric_limits<int64_t>::max()) ? indexedCount : lowerBound(query.to);
+    if (first >= last)
+    {
+        return builder.finish();
+    }
+
+    // 把每个条件的位置列表截到时间范围内，选出最短的一段作为扫描对象
+    const vector<uint32_t>* driver = nullptr;
+    size_t begin = first;
+    size_t end = last;
+    auto narrow = [&](const PostingLists& lists, int64_t value)
+    {
+        if (value == HISTORY_ANY)
+        {
+            return true;
+        }
+        auto it = lists.find(static_cast<uint32_t>(value));
+        if (it == lists.end())
+        {
+            return false;
+        }
+        const vector<uint32_t>& positions = it->second;
+        size_t low = lower_bound(positions.begin(), positions.end(), static_cast<uint32_t>(first)) - positions.begin();
+        size_t high = lower_bound(positions.begin(), positions.end(), static_cast<uint32_t>(last)) - positions.begin();
+        if (high - low < end - begin)
+        {
+            driver = &positions;
+            begin = low;
+            end = high;
+        }
+        return true;
+    };
+    if (!narrow(byMode, query.mode) || !narrow(byDifficulty, query.difficulty) || !narrow(byCorpus, query.corpusId))
+    {
+        return builder.finish();
+    }
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const SessionRecord& record = recordAt(driver != nullptr ? (*driver)[i] : i);
+        if (query.matches(record))
+        {
+            builder.add(record);
+        }
+    }
+    return builder.finish();
+}
@@ -0,0 +1,81 @@
+#ifndef HISTORY_INDEX_H
+#define HISTORY_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <vector>
+#include "session_history.h"
+
+// 查询条件中表示“不过滤”的值
+const int HISTORY_ANY = -1;
+
+// 练习历史的查询条件：时间范围[from, to)，以及模式、难度和语料编号（HISTORY_ANY表示不过滤）
+struct HistoryQuery
+{
+    int64_t from = std::numeric_limits<int64_t>::min();
+    int64_t to = std::numeric_limits<int64_t>::max();
+    int mode = HISTORY_ANY;        // PracticeMode
+    int difficulty = HISTORY_ANY;  // DifficultyLevel
+    int64_t corpusId = HISTORY_ANY;
+
+    // 记录是否满足全部条件
+    bool matches(const SessionRecord& record) const;
+};
+
+// 练习历史的查询索引
+// 主索引是按时间排序的记录顺序（记录按追加顺序本来就有序时不占内存），时间范围用二分查找；
+// 模式、难度和语料编号各有一组按时间顺序排列的位置列表。查询时先用二分查找把每个条件的列表
+// 截到时间范围内，从最短的一个开始逐条检查其余条件，只访问可能命中的记录。
+// 练习结束后只把新追加的记录加入索引，系统时间被调回导致记录无序时整体重建
+class HistoryIndex
+{
+public:
+    explicit HistoryIndex(const SessionHistory& history) : history(history) {}
+
+    HistoryIndex(const HistoryIndex&) = delete;
+    HistoryIndex& operator=(const HistoryIndex&) = delete;
+
+    // 清空索引（历史文件换成另一个用户的文件时调用）
+    void clear();
+
+    // 把历史中尚未索引的记录加入索引（历史重新映射之后调用）
+    void refresh();
+
+    // 汇总满足条件的记录
+    HistorySummary summarize(const HistoryQuery& query) const;
+
+    // 已索引的记录数
+    size_t size() const { return indexedCount; }
+
+    const SessionHistory& getHistory() const { return history; }
+
+    // 按时间顺序访问已索引的记录（position小于size()）
+    const SessionRecord& recordAt(size_t position) const
+    {
+        return history.records()[order.empty() ? position : order[position]];
+    }
+
+    // 时间顺序中第一个时间不早于timestamp的位置
+    size_t lowerBound(int64_t timestamp) const;
+
+private:
+    typedef std::map<uint32_t, std::vector<uint32_t>> PostingLists;  // 取值 -> 按时间顺序的位置
+
+    const SessionHistory& history;
+    size_t indexedCount = 0;
+    int64_t lastTimestamp = std::numeric_limits<int64_t>::min();
+    std::vector<uint32_t> order;  // 时间顺序中每个位置对应的记录下标，记录本身有序时为空
+    PostingLists byMode;
+    PostingLists byDifficulty;
+    PostingLists byCorpus;
+
+    // 按时间排序后重建全部索引
+    void rebuild();
+
+    // 把position处的记录加入各个位置列表
+    void addPosition(uint32_t position, const SessionRecord& record);
+};
+
+#endif // HISTORY_INDEX_H
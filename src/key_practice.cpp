@@ -324,13 +324,24 @@ void KeyboardPractice::changePracticeType(KeyPracticeType type)
     // 重置练习状态
     currentPos = 0;
     userInput = "";
-    errorCount.clear();
+    keyStats.clear();
+    score.reset();
 }
 
 // 处理用户输入
 bool KeyboardPractice::processInput()
 {
+    // 反应时间：从界面准备好等待输入到按键的时间
+    auto waitStart = steady_clock::now();
     int ch = getch();
+    double reactionMs = duration<double, milli>(steady_clock::now() - waitStart).count();
+    
+    // 终端大小改变：调整主窗口后按新尺寸重建键盘和菜单窗口
+    if (ch == KEY_RESIZE) {
+        GUIHelper::resizeWindows(headerWin, contentWin, statusWin);
+        drawKeyboardPracticeScreen();
+        return true;
+    }
     
     // 如果菜单可见，优先处理菜单输入
     if (menuVisible) {
@@ -400,6 +411,7 @@ bool KeyboardPractice::processInput()
     // 处理退格键
     if (ch == KEY_BACKSPACE || ch == KEY_BACKSPACE_ALT || ch == 127) {
         if (currentPos > 0 && !userInput.empty()) {
+            score.removeChar(userInput.back() == practiceText[currentPos - 1]);
             userInput.pop_back();
             currentPos--;
             
@@ -424,10 +436,11 @@ bool KeyboardPractice::processInput()
         
         // 检查是否正确
         bool correct = (typedChar == practiceText[currentPos]);
+        score.recordChar(correct);
+        keyStats.record(static_cast<unsigned char>(practiceText[currentPos]), correct, correct ? reactionMs : -1.0);
         
-        // 如果错误，记录错误
+        // 如果错误，提示正确的键
         if (!correct) {
-            errorCount[practiceText[currentPos]]++;
             
             // 高亮错误键
             highlightKey(typedChar, COLOR_INCORRECT);
@@ -571,17 +584,10 @@ void KeyboardPractice::showResults()
     // 清空内容窗口
     wclear(contentWin);
     
-    // 计算准确率
-    int totalChars = userInput.length();
-    int correctChars = 0;
-    
-    for (size_t i = 0; i < min(userInput.length(), practiceText.length()); i++) {
-        if (userInput[i] == practiceText[i]) {
-            correctChars++;
-        }
-    }
-    
-    double accuracy = totalChars > 0 ? (correctChars * 100.0 / totalChars) : 0;
+    // 成绩在练习过程中已增量统计
+    int totalChars = static_cast<int>(score.getTypedCount());
+    int correctChars = static_cast<int>(score.getCorrectCount());
+    double accuracy = score.accuracy();
     
     // 显示结果
     wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
@@ -594,21 +600,20 @@ void KeyboardPractice::showResults()
     mvwprintw(contentWin, 6, 2, "Accuracy: %.1f%%", accuracy);
     
     // 显示常见错误
-    if (!errorCount.empty()) {
+    RankedEntry topKeys[5];
+    size_t errorKeys = keyStats.topErrors(topKeys, 5);
+    if (errorKeys > 0) {
         mvwprintw(contentWin, 8, 2, "Most common errors:");
         
-        // 排序错误计数
-        vector<pair<char, int>> sortedErrors(errorCount.begin(), errorCount.end());
-        sort(sortedErrors.begin(), sortedErrors.end(),
-             [](const pair<char, int>& a, const pair<char, int>& b) {
-                 return a.second > b.second;
-             });
-        
-        // 显示前5个最常见错误
+        // 显示前5个最常见错误，以及该键正确输入时的平均反应时间
         int row = 9;
-        for (size_t i = 0; i < min(size_t(5), sortedErrors.size()); i++) {
-            mvwprintw(contentWin, row++, 4, "Character '%c': %d times", 
-                      sortedErrors[i].first, sortedErrors[i].second);
+        for (size_t i = 0; i < errorKeys; i++) {
+            unsigned char key = static_cast<unsigned char>(topKeys[i].index);
+            mvwprintw(contentWin, row, 4, "Character '%c': %u times", key, topKeys[i].value);
+            if (keyStats.getLatencySamples(key) > 0) {
+                wprintw(contentWin, " (%.0f ms)", keyStats.getMeanLatency(key));
+            }
+            row++;
         }
     }
     
@@ -6,6 +6,8 @@
 #include <vector>
 #include <map>
 #include "gui_helper.h"
+#include "typing_score.h"
+#include "key_stats.h"
 
 // 键位练习类型枚举
 enum KeyPracticeType {
@@ -33,7 +35,8 @@ private:
     std::string practiceText;
     std::string userInput;
     int currentPos;
-    std::map<char, int> errorCount;  // 错误统计
+    KeyStatsTable keyStats;          // 每个键的次数、错误和反应时间
+    TypingScore score;               // 成绩计数，与文本练习共用计分规则
     
     // 菜单数据
     std::vector<std::string> menuItems;  // 菜单项
@@ -0,0 +1,220 @@
+#include "key_stats.h"
+#include "keystroke_log.h"
+#include <cstring>
+
+using namespace std;
+
+// 选出最大的maxCount个值
+size_t selectTopK(const uint32_t* values, size_t size, RankedEntry* out, size_t maxCount)
+{
+    const size_t BLOCK = 16;
+
+    size_t found = 0;
+    uint32_t threshold = 0;  // 进入排名需要超过的值
+    for (size_t start = 0; start < size && maxCount > 0; start += BLOCK)
+    {
+        size_t end = (size - start < BLOCK) ? size : start + BLOCK;
+
+        uint32_t blockMax = 0;
+        for (size_t i = start; i < end; i++)
+        {
+            blockMax = values[i] > blockMax ? values[i] : blockMax;
+        }
+        if (blockMax <= threshold)
+        {
+            continue;
+        }
+
+        for (size_t i = start; i < end; i++)
+        {
+            uint32_t value = values[i];
+            if (value <= threshold)
+            {
+                continue;
+            }
+
+            // 插入到有序的排名中，排名已满时替换最后一名
+            size_t pos = (found < maxCount) ? found++ : maxCount - 1;
+            while (pos > 0 && out[pos - 1].value < value)
+            {
+                out[pos] = out[pos - 1];
+                pos--;
+            }
+            out[pos].index = static_cast<uint32_t>(i);
+            out[pos].value = value;
+
+            if (found == maxCount)
+            {
+                threshold = out[maxCount - 1].value;
+            }
+        }
+    }
+    return found;
+}
+
+// 清空
+void KeyStatsTable::clear()
+{
+    memset(counts, 0, sizeof(counts));
+    memset(errors, 0, sizeof(errors));
+    memset(latencySamples, 0, sizeof(latencySamples));
+    for (size_t i = 0; i < KEY_COUNT; i++)
+    {
+        latencyMean[i] = 0.0;
+        latencyM2[i] = 0.0;
+    }
+}
+
+// 记录一次按键
+void KeyStatsTable::record(unsigned char key, bool correct, double latencyMs)
+{
+    if (key >= KEY_COUNT)
+    {
+        return;
+    }
+    counts[key]++;
+    if (!correct)
+    {
+        errors[key]++;
+    }
+
+    // Welford算法逐个更新均值和平方和，不需要保存样本
+    if (latencyMs >= 0.0)
+    {
+        uint32_t n = ++latencySamples[key];
+        double delta = latencyMs - latencyMean[key];
+        latencyMean[key] += delta / n;
+        latencyM2[key] += delta * (latencyMs - latencyMean[key]);
+    }
+}
+
+// 累加错误次数
+void KeyStatsTable::addErrors(unsigned char key, uint32_t count)
+{
+    if (key < KEY_COUNT)
+    {
+        errors[key] += count;
+    }
+}
+
+// 从逐键记录中统计
+void KeyStatsTable::addLog(const KeystrokeLog& log)
+{
+    // 上一个事件是按键，间隔有效；记录前面的事件已被丢弃时看最后一个被丢弃的事件
+    KeystrokeKind lastDiscarded = log.getLastDiscardedKind();
+    bool hasInterval = log.getDiscardedCount() > 0 && (lastDiscarded == KEYSTROKE_CHAR || lastDiscarded == KEYSTROKE_BACKSPACE);
+    for (size_t i = 0; i < log.size(); i++)
+    {
+        KeystrokeKind kind = log.kind(i);
+        if (kind == KEYSTROKE_CHAR)
+        {
+            char32_t expected = log.expected(i);
+            if (expected < KEY_COUNT)
+            {
+                bool correct = log.correct(i);
+                double latencyMs = (hasInterval && correct) ? log.interKeyNs(i) / 1e6 : -1.0;
+                record(static_cast<unsigned char>(expected), correct, latencyMs);
+            }
+            hasInterval = true;
+        }
+        else
+        {
+            // 退格之后的间隔有效，暂停和继续之后无效
+            hasInterval = (kind == KEYSTROKE_BACKSPACE);
+        }
+    }
+}
+
+// 合并另一张表
+void KeyStatsTable::merge(const KeyStatsTable& other)
+{
+    for (size_t i = 0; i < KEY_COUNT; i++)
+    {
+        counts[i] += other.counts[i];
+        errors[i] += other.errors[i];
+
+        uint32_t na = latencySamples[i];
+        uint32_t nb = other.latencySamples[i];
+        if (nb == 0)
+        {
+            continue;
+        }
+        double n = static_cast<double>(na) + nb;
+        double delta = other.latencyMean[i] - latencyMean[i];
+        latencyMean[i] += delta * nb / n;
+        latencyM2[i] += other.latencyM2[i] + delta * delta * na * nb / n;
+        latencySamples[i] = na + nb;
+    }
+}
+
+// 直接设置一个键
+void KeyStatsTable::set(unsigned char key, uint32_t count, uint32_t errorCount, uint32_t samples, double meanMs, double m2)
+{
+    if (key >= KEY_COUNT)
+    {
+        return;
+    }
+    counts[key] = count;
+    errors[key] = errorCount;
+    latencySamples[key] = samples;
+    latencyMean[key] = samples > 0 ? meanMs : 0.0;
+    latencyM2[key] = samples > 1 ? m2 : 0.0;
+}
+
+// 延迟的方差
+double KeyStatsTable::getLatencyVariance(unsigned char key) const
+{
+    if (key >= KEY_COUNT || latencySamples[key] < 2)
+    {
+        return 0.0;
+    }
+    return latencyM2[key] / (latencySamples[key] - 1);
+}
+
+// 是否有任何数据
+bool KeyStatsTable::isEmpty() const
+{
+    uint32_t any = 0;
+    for (size_t i = 0; i < KEY_COUNT; i++)
+    {
+        any |= counts[i] | errors[i];
+    }
+    return any == 0;
+}
+
+// 是否有错误
+bool KeyStatsTable::hasErrors() const
+{
+    uint32_t any = 0;
+    for (size_t i = 0; i < KEY_COUNT; i++)
+    {
+        any |= errors[i];
+    }
+    return any != 0;
+}
+
+// 清空
+void BigramMatrix::clear()
+{
+    memset(cells, 0, sizeof(cells));
+}
+
+// 累加错误次数
+void BigramMatrix::add(unsigned char first, unsigned char second, uint32_t count)
+{
+    if (contains(first, second))
+    {
+        cells[indexOf(first, second)] += count;
+    }
+}
+
+// 是否为空
+bool BigramMatrix::isEmpty() const
+{
+    uint32_t any = 0;
+    for (size_t i = 0; i < CELL_COUNT; i++)
+    {
+        any |= cells[i];
+    }
+    return any == 0;
+}
@@ -0,0 +1,119 @@
+#ifndef KEY_STATS_H
+#define KEY_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+
+class KeystrokeLog;
+
+// 排名中的一项：数组下标和对应的值
+struct RankedEntry
+{
+    uint32_t index = 0;
+    uint32_t value = 0;
+};
+
+// 从values中选出最大的maxCount个非零值写入out，按值降序（值相同时下标小的在前），返回选出的个数。
+// 数组按16项分块，先用无分支循环求块内最大值（编译器可以向量化），
+// 块内最大值不超过当前第maxCount名时整块跳过，稀疏的大表只需一次顺序扫描
+size_t selectTopK(const uint32_t* values, size_t size, RankedEntry* out, size_t maxCount);
+
+// 每个ASCII键的统计：输入次数、错误次数，以及按键间隔的均值和方差
+// 各项分别存放在128项的定长数组中，记录一次按键只更新同一下标的几个数组元素
+class KeyStatsTable
+{
+public:
+    static const size_t KEY_COUNT = 128;
+
+    KeyStatsTable() { clear(); }
+
+    void clear();
+
+    // 记录一次按键：key为应输入的字符，latencyMs小于0表示这次按键没有可用的间隔
+    // 以下修改函数都忽略超出ASCII范围的键（不能折算到其他键上）
+    void record(unsigned char key, bool correct, double latencyMs);
+
+    // 累加错误次数（旧统计文件只记录了错误数）
+    void addErrors(unsigned char key, uint32_t count);
+
+    // 从逐键记录中统计应输入ASCII字符的按键；只有正确按键的间隔计入延迟，
+    // 暂停前后和练习开始的第一个按键没有间隔；记录中已丢弃的事件由调用者事先统计过
+    void addLog(const KeystrokeLog& log);
+
+    // 合并另一张表（延迟的均值和方差按并行算法合并）
+    void merge(const KeyStatsTable& other);
+
+    // 直接设置一个键的全部数据（读取统计文件时使用）
+    void set(unsigned char key, uint32_t count, uint32_t errorCount, uint32_t samples, double meanMs, double m2);
+
+    // 超出ASCII范围的键没有记录，返回0
+    uint32_t getCount(unsigned char key) const { return key < KEY_COUNT ? counts[key] : 0; }
+    uint32_t getErrors(unsigned char key) const { return key < KEY_COUNT ? errors[key] : 0; }
+    uint32_t getLatencySamples(unsigned char key) const { return key < KEY_COUNT ? latencySamples[key] : 0; }
+    double getMeanLatency(unsigned char key) const { return key < KEY_COUNT ? latencyMean[key] : 0.0; }
+    double getLatencyM2(unsigned char key) const { return key < KEY_COUNT ? latencyM2[key] : 0.0; }
+
+    // 延迟的方差（毫秒的平方），少于两个样本时为0
+    double getLatencyVariance(unsigned char key) const;
+
+    // 是否有任何键记录过数据
+    bool isEmpty() const;
+    bool hasErrors() const;
+
+    // 错误最多的键，RankedEntry::index为字符
+    size_t topErrors(RankedEntry* out, size_t maxCount) const { return selectTopK(errors, KEY_COUNT, out, maxCount); }
+
+private:
+    uint32_t counts[KEY_COUNT];
+    uint32_t errors[KEY_COUNT];
+    uint32_t latencySamples[KEY_COUNT];
+    double latencyMean[KEY_COUNT];   // 毫秒
+    double latencyM2[KEY_COUNT];     // 与均值之差的平方和（Welford算法）
+};
+
+// 可打印ASCII字符（0x20~0x7F，共96个）两两组合的错误次数矩阵
+class BigramMatrix
+{
+public:
+    static const size_t FIRST_CHAR = 0x20;
+    static const size_t CHAR_COUNT = 96;
+    static const size_t CELL_COUNT = CHAR_COUNT * CHAR_COUNT;
+
+    BigramMatrix() { clear(); }
+
+    void clear();
+
+    // 两个字符是否都在矩阵范围内
+    static bool contains(unsigned char first, unsigned char second)
+    {
+        return first >= FIRST_CHAR && first < FIRST_CHAR + CHAR_COUNT &&
+               second >= FIRST_CHAR && second < FIRST_CHAR + CHAR_COUNT;
+    }
+
+    // 下标与字符组合之间的转换
+    static uint32_t indexOf(unsigned char first, unsigned char second)
+    {
+        return static_cast<uint32_t>((first - FIRST_CHAR) * CHAR_COUNT + (second - FIRST_CHAR));
+    }
+    static unsigned char firstOf(uint32_t index) { return static_cast<unsigned char>(FIRST_CHAR + index / CHAR_COUNT); }
+    static unsigned char secondOf(uint32_t index) { return static_cast<unsigned char>(FIRST_CHAR + index % CHAR_COUNT); }
+
+    // 累加错误次数，范围外的组合被忽略
+    void add(unsigned char first, unsigned char second, uint32_t count);
+
+    uint32_t get(unsigned char first, unsigned char second) const
+    {
+        return contains(first, second) ? cells[indexOf(first, second)] : 0;
+    }
+    uint32_t getCell(uint32_t index) const { return cells[index]; }
+
+    bool isEmpty() const;
+
+    // 错误最多的组合，RankedEntry::index为矩阵下标
+    size_t topErrors(RankedEntry* out, size_t maxCount) const { return selectTopK(cells, CELL_COUNT, out, maxCount); }
+
+private:
+    uint32_t cells[CELL_COUNT];
+};
+
+#endif // KEY_STATS_H
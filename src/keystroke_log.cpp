@@ -0,0 +1,86 @@
+#include "keystroke_log.h"
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+// 构造函数
+KeystrokeLog::KeystrokeLog()
+{
+    begin(steady_clock::now(), 0);
+}
+
+// 开始新的记录
+void KeystrokeLog::begin(TimePoint start, size_t minCapacity)
+{
+    startTime = start;
+    count = 0;
+    growCount = 0;
+    discardedEvents = 0;
+    discardedTimeNs = 0;
+    discardedKind = KEYSTROKE_CHAR;
+
+    // 复用已有缓冲区，只有容量不足时才重新分配
+    if (minCapacity > capacity)
+    {
+        capacity = minCapacity;
+        times.resize(capacity);
+        kinds.resize(capacity);
+        expectedChars.resize(capacity);
+        typedChars.resize(capacity);
+        correctFlags.resize(capacity);
+        positions.resize(capacity);
+    }
+}
+
+// 记录一次按键
+void KeystrokeLog::record(TimePoint time, KeystrokeKind kind, char32_t expected, char32_t typed, bool correct, uint32_t position)
+{
+    if (count == capacity)
+    {
+        grow();
+    }
+
+    times[count] = duration_cast<nanoseconds>(time - startTime).count();
+    kinds[count] = kind;
+    expectedChars[count] = expected;
+    typedChars[count] = typed;
+    correctFlags[count] = correct ? 1 : 0;
+    positions[count] = position;
+    count++;
+}
+
+// 丢弃前面的事件
+void KeystrokeLog::discardPrefix(size_t discard)
+{
+    discard = min(discard, count);
+    if (discard == 0)
+    {
+        return;
+    }
+
+    discardedKind = static_cast<KeystrokeKind>(kinds[discard - 1]);
+    discardedTimeNs = times[discard - 1];
+
+    move(times.begin() + discard, times.begin() + count, times.begin());
+    move(kinds.begin() + discard, kinds.begin() + count, kinds.begin());
+    move(expectedChars.begin() + discard, expectedChars.begin() + count, expectedChars.begin());
+    move(typedChars.begin() + discard, typedChars.begin() + count, typedChars.begin());
+    move(correctFlags.begin() + discard, correctFlags.begin() + count, correctFlags.begin());
+    move(positions.begin() + discard, positions.begin() + count, positions.begin());
+    count -= discard;
+    discardedEvents += discard;
+}
+
+// 缓冲区加倍扩容
+void KeystrokeLog::grow()
+{
+    capacity = (capacity == 0) ? 256 : capacity * 2;
+    times.resize(capacity);
+    kinds.resize(capacity);
+    expectedChars.resize(capacity);
+    typedChars.resize(capacity);
+    correctFlags.resize(capacity);
+    positions.resize(capacity);
+    growCount++;
+}
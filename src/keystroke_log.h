@@ -0,0 +1,85 @@
+#ifndef KEYSTROKE_LOG_H
+#define KEYSTROKE_LOG_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// 按键事件类型
+enum KeystrokeKind : uint8_t
+{
+    KEYSTROKE_CHAR = 0,      // 输入字符
+    KEYSTROKE_BACKSPACE = 1, // 退格
+    KEYSTROKE_PAUSE = 2,     // 暂停开始（手动暂停、对话框或空闲）
+    KEYSTROKE_RESUME = 3     // 暂停结束
+};
+
+// 单次练习的逐键记录
+// 采用结构数组（SoA）布局，缓冲区在练习开始前一次性分配，
+// 记录按键时只写入已分配的内存，不会触发分配
+class KeystrokeLog
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    KeystrokeLog();
+
+    // 开始新的记录：清空已有事件，并确保至少能容纳capacity个事件
+    void begin(TimePoint startTime, size_t capacity);
+
+    // 记录一次按键
+    // position 为处理该按键后的光标位置
+    // expected/typed 为Unicode码位
+    void record(TimePoint time, KeystrokeKind kind, char32_t expected, char32_t typed, bool correct, uint32_t position);
+
+    // 事件数量
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // 练习开始时间
+    TimePoint getStartTime() const { return startTime; }
+
+    // 访问第i个事件
+    int64_t timeNs(size_t i) const { return times[i]; }            // 距练习开始的纳秒数
+    KeystrokeKind kind(size_t i) const { return static_cast<KeystrokeKind>(kinds[i]); }
+    char32_t expected(size_t i) const { return expectedChars[i]; }
+    char32_t typed(size_t i) const { return typedChars[i]; }
+    bool correct(size_t i) const { return correctFlags[i] != 0; }
+    uint32_t position(size_t i) const { return positions[i]; }
+
+    // 与上一次按键的间隔（纳秒），第一个事件相对于最后一个被丢弃的事件（没有丢弃时为练习开始）
+    int64_t interKeyNs(size_t i) const { return i == 0 ? times[0] - discardedTimeNs : times[i] - times[i - 1]; }
+
+    // 丢弃前count个事件，之后的事件整体前移，缓冲区不释放
+    // （无尽模式下已统计过的事件移出记录，保持内存恒定）
+    void discardPrefix(size_t count);
+
+    // 已丢弃的事件数，以及最后一个被丢弃事件的类型
+    size_t getDiscardedCount() const { return discardedEvents; }
+    KeystrokeKind getLastDiscardedKind() const { return discardedKind; }
+
+    // 缓冲区扩容次数（正常情况下应为0，用于检查预分配是否足够）
+    int getGrowCount() const { return growCount; }
+
+private:
+    // 缓冲区已满时加倍扩容（冷路径）
+    void grow();
+
+    TimePoint startTime;
+    size_t count = 0;
+    size_t capacity = 0;
+    int growCount = 0;
+
+    size_t discardedEvents = 0;
+    int64_t discardedTimeNs = 0;  // 最后一个被丢弃事件的时间
+    KeystrokeKind discardedKind = KEYSTROKE_CHAR;
+
+    std::vector<int64_t> times;
+    std::vector<uint8_t> kinds;
+    std::vector<char32_t> expectedChars;
+    std::vector<char32_t> typedChars;
+    std::vector<uint8_t> correctFlags;
+    std::vector<uint32_t> positions;
+};
+
+#endif // KEYSTROKE_LOG_H
@@ -0,0 +1,99 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace std::chrono;
+
+// 构造函数：桶数组只分配一次
+LatencyHistogram::LatencyHistogram()
+    : buckets((MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT, 0)
+{
+}
+
+// 清空所有样本
+void LatencyHistogram::reset()
+{
+    fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    maxValue = 0;
+}
+
+// 记录一个样本
+void LatencyHistogram::record(int64_t nanoseconds)
+{
+    nanoseconds = max<int64_t>(nanoseconds, 0);
+    buckets[bucketIndex(nanoseconds)]++;
+    count++;
+    maxValue = max(maxValue, nanoseconds);
+}
+
+void LatencyHistogram::record(steady_clock::duration elapsed)
+{
+    record(static_cast<int64_t>(duration_cast<nanoseconds>(elapsed).count()));
+}
+
+// 百分位数
+int64_t LatencyHistogram::percentile(double percentile) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // 至少需要覆盖的样本数（向上取整，至少为1）
+    uint64_t target = static_cast<uint64_t>(ceil(percentile / 100.0 * count));
+    target = min(max<uint64_t>(target, 1), count);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        seen += buckets[i];
+        if (seen >= target)
+        {
+            // 桶上界可能超过实际最大值
+            return min(bucketUpperBound(i), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+// 样本值对应的桶下标
+// 小于32的值直接作为下标；否则按最高位所在的指数分组，组内取紧跟最高位的5位作为子桶
+size_t LatencyHistogram::bucketIndex(int64_t value)
+{
+    uint64_t v = static_cast<uint64_t>(value);
+    if (v < static_cast<uint64_t>(SUB_BUCKET_COUNT))
+    {
+        return static_cast<size_t>(v);
+    }
+
+    int exponent = 63;
+    while (!(v >> exponent))
+    {
+        exponent--;
+    }
+
+    if (exponent > MAX_EXPONENT)
+    {
+        return (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT - 1;
+    }
+
+    int shift = exponent - SUB_BUCKET_BITS;
+    size_t sub = static_cast<size_t>((v >> shift) & (SUB_BUCKET_COUNT - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub;
+}
+
+// 桶内样本值的上界
+int64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    if (index < static_cast<size_t>(SUB_BUCKET_COUNT))
+    {
+        return static_cast<int64_t>(index);
+    }
+
+    int shift = static_cast<int>(index / SUB_BUCKET_COUNT) - 1;
+    int64_t sub = static_cast<int64_t>(index % SUB_BUCKET_COUNT);
+    int64_t lower = (SUB_BUCKET_COUNT + sub) << shift;
+    return lower + (int64_t(1) << shift) - 1;
+}
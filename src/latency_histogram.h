@@ -0,0 +1,44 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// HDR风格的延迟直方图（单位：纳秒）
+// 每个2的幂区间再线性划分为32个子桶，相对误差约3%；
+// 记录一次样本只做一次位运算和一次数组加法，不分配内存
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    // 清空所有样本
+    void reset();
+
+    // 记录一个样本
+    void record(int64_t nanoseconds);
+    void record(std::chrono::steady_clock::duration elapsed);
+
+    // 样本数和最大值
+    uint64_t getCount() const { return count; }
+    int64_t getMax() const { return maxValue; }
+
+    // 百分位数（percentile取0~100），返回所在桶的上界
+    int64_t percentile(double percentile) const;
+
+private:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static const int MAX_EXPONENT = 40;  // 超过约18分钟的样本计入最后一个桶
+
+    // 样本值与桶下标的相互换算
+    static size_t bucketIndex(int64_t value);
+    static int64_t bucketUpperBound(size_t index);
+
+    std::vector<uint32_t> buckets;
+    uint64_t count = 0;
+    int64_t maxValue = 0;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,139 @@
+#include "live_stats.h"
+#include <algorithm>
+#include <cstdio>
+
+using namespace std;
+using namespace std::chrono;
+
+// 构造函数
+RollingKeyCounter::RollingKeyCounter(size_t capacity, const vector<double>& windowSeconds)
+    : ring(capacity)
+{
+    for (double seconds : windowSeconds)
+    {
+        Window window;
+        window.seconds = seconds;
+        window.length = duration_cast<steady_clock::duration>(duration<double>(seconds));
+        window.tail = 0;
+        windows.push_back(window);
+    }
+}
+
+// 清空所有记录
+void RollingKeyCounter::reset()
+{
+    head = 0;
+    for (auto& window : windows)
+    {
+        window.tail = 0;
+    }
+}
+
+// 记录一次按键
+void RollingKeyCounter::push(TimePoint time)
+{
+    ring[head % ring.size()] = time;
+    head++;
+
+    // 缓冲区已满时，被覆盖的记录移出所有窗口
+    for (auto& window : windows)
+    {
+        if (head - window.tail > ring.size())
+        {
+            window.tail = head - ring.size();
+        }
+    }
+}
+
+// 按键时间整体后移
+void RollingKeyCounter::shift(steady_clock::duration offset)
+{
+    size_t first = (head > ring.size()) ? head - ring.size() : 0;
+    for (size_t i = first; i < head; i++)
+    {
+        ring[i % ring.size()] += offset;
+    }
+}
+
+// 获取指定窗口内的按键数
+int RollingKeyCounter::countInWindow(size_t windowIndex, TimePoint now)
+{
+    Window& window = windows[windowIndex];
+    TimePoint windowStart = now - window.length;
+
+    // 尾指针只会前进，因此总开销与按键数成正比
+    while (window.tail < head && ring[window.tail % ring.size()] < windowStart)
+    {
+        window.tail++;
+    }
+
+    return static_cast<int>(head - window.tail);
+}
+
+// 构造函数：5秒和30秒两个窗口，容量按每秒40次按键预留
+LiveStats::LiveStats() : keyCounter(2048, {5.0, 30.0})
+{
+    start(steady_clock::now());
+}
+
+// 开始新的练习
+void LiveStats::start(TimePoint time)
+{
+    keyCounter.reset();
+    startTime = time;
+}
+
+// 记录一次字符输入
+void LiveStats::recordKey(TimePoint time)
+{
+    keyCounter.push(time);
+}
+
+// 扣除暂停时间
+void LiveStats::excludeTime(steady_clock::duration paused)
+{
+    startTime += paused;
+    keyCounter.shift(paused);
+}
+
+// 滚动窗口内的瞬时速度
+double LiveStats::windowWPM(size_t windowIndex, TimePoint now)
+{
+    int keys = keyCounter.countInWindow(windowIndex, now);
+
+    // 练习刚开始时窗口尚未填满，按实际经过的时间计算
+    double seconds = min(keyCounter.getWindowSeconds(windowIndex), elapsedSeconds(now));
+    if (seconds <= 0)
+    {
+        return 0;
+    }
+    return (keys / 5.0) / (seconds / 60.0);
+}
+
+// 已用时间
+double LiveStats::elapsedSeconds(TimePoint now) const
+{
+    return duration_cast<milliseconds>(now - startTime).count() / 1000.0;
+}
+
+// 生成状态栏HUD文本
+string LiveStats::formatStatusLine(TimePoint now, int progress, const TypingScore& score)
+{
+    double seconds = elapsedSeconds(now);
+    int elapsed = static_cast<int>(seconds);
+
+    char hud[160];
+    snprintf(hud, sizeof(hud), "WPM 5s:%.0f 30s:%.0f Net:%.0f | Acc:%.1f%% | %d:%02d",
+             windowWPM(WINDOW_SHORT, now),
+             windowWPM(WINDOW_LONG, now),
+             score.netWPM(seconds),
+             score.accuracy(),
+             elapsed / 60, elapsed % 60);
+
+    // 进度为负数时（如无尽模式）不显示百分比
+    if (progress < 0)
+    {
+        return hud;
+    }
+    return to_string(progress) + "% | " + hud;
+}
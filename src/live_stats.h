@@ -0,0 +1,83 @@
+#ifndef LIVE_STATS_H
+#define LIVE_STATS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "typing_score.h"
+
+// 滚动时间窗口按键计数器
+// 所有窗口共享同一个环形缓冲区，每个窗口只维护自己的尾指针，
+// 记录按键和查询计数均为均摊O(1)
+class RollingKeyCounter
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // capacity 必须能容纳最长窗口内的按键数
+    RollingKeyCounter(size_t capacity, const std::vector<double>& windowSeconds);
+
+    // 清空所有记录
+    void reset();
+
+    // 记录一次按键
+    void push(TimePoint time);
+
+    // 将已记录的按键时间整体后移（暂停结束时调用，暂停期间不计入窗口）
+    void shift(std::chrono::steady_clock::duration offset);
+
+    // 获取指定窗口内（截至now）的按键数
+    int countInWindow(size_t windowIndex, TimePoint now);
+
+    // 获取窗口长度（秒）
+    double getWindowSeconds(size_t windowIndex) const { return windows[windowIndex].seconds; }
+
+private:
+    struct Window
+    {
+        double seconds;
+        std::chrono::steady_clock::duration length;
+        size_t tail;  // 窗口内最早一次按键的序号
+    };
+
+    std::vector<TimePoint> ring;
+    std::vector<Window> windows;
+    size_t head = 0;  // 下一次按键的序号（单调递增，取模得到环形缓冲区下标）
+};
+
+// 练习过程中的实时统计（用于状态栏HUD）
+class LiveStats
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    // 滚动窗口下标
+    static const size_t WINDOW_SHORT = 0;  // 最近5秒
+    static const size_t WINDOW_LONG = 1;   // 最近30秒
+
+    LiveStats();
+
+    // 开始新的练习
+    void start(TimePoint time);
+
+    // 记录一次字符输入
+    void recordKey(TimePoint time);
+
+    // 从已用时间和滚动窗口中扣除一段暂停时间
+    void excludeTime(std::chrono::steady_clock::duration paused);
+
+    // 滚动窗口内的瞬时速度（WPM）
+    double windowWPM(size_t windowIndex, TimePoint now);
+
+    // 已用时间（秒）
+    double elapsedSeconds(TimePoint now) const;
+
+    // 生成状态栏HUD文本，净速度和准确率取自练习成绩；progress为负数时不显示进度
+    std::string formatStatusLine(TimePoint now, int progress, const TypingScore& score);
+
+private:
+    RollingKeyCounter keyCounter;
+    TimePoint startTime;
+};
+
+#endif // LIVE_STATS_H
@@ -0,0 +1,294 @@
+#include "race_client.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace std::chrono;
+using namespace RaceProtocol;
+
+// 析构函数
+RaceClient::~RaceClient()
+{
+    disconnect();
+}
+
+// 处理一条消息
+bool RaceClient::handleFrame(const Frame& frame)
+{
+    switch (frame.type)
+    {
+    case MSG_WELCOME:
+        if (frame.length >= 2)
+        {
+            racerId = getU16(frame.payload);
+        }
+        return false;
+
+    case MSG_TEXT:
+        text.assign(frame.payload, frame.length);
+        textReceived = true;
+        return true;
+
+    case MSG_RACER:
+        if (frame.length >= 2 && findRacer(getU16(frame.payload)) == nullptr)
+        {
+            RacerInfo racer;
+            racer.id = getU16(frame.payload);
+            racer.name.assign(frame.payload + 2, frame.length - 2);
+            // 按编号（即加入顺序）排列
+            auto it = lower_bound(racers.begin(), racers.end(), racer.id,
+                                  [](const RacerInfo& entry, uint16_t id) { return entry.id < id; });
+            racers.insert(it, racer);
+            return true;
+        }
+        return false;
+
+    case MSG_LEAVE:
+        if (frame.length >= 2)
+        {
+            uint16_t id = getU16(frame.payload);
+            if (countdownStarted)
+            {
+                // 比赛开始后保留离开选手的最后进度
+                RacerInfo* racer = findRacer(id);
+                if (racer != nullptr)
+                {
+                    racer->connected = false;
+                }
+            }
+            else
+            {
+                racers.erase(remove_if(racers.begin(), racers.end(),
+                                       [id](const RacerInfo& racer) { return racer.id == id; }),
+                             racers.end());
+            }
+            return true;
+        }
+        return false;
+
+    case MSG_COUNTDOWN:
+        if (frame.length >= 2 && !countdownStarted)
+        {
+            countdownStarted = true;
+            startTime = steady_clock::now() + milliseconds(getU16(frame.payload));
+            return true;
+        }
+        return false;
+
+    case MSG_STANDINGS:
+    {
+        if (frame.length < 2)
+        {
+            return false;
+        }
+        size_t count = getU16(frame.payload);
+        bool changed = false;
+        for (size_t i = 0; i < count && 2 + (i + 1) * STANDING_SIZE <= frame.length; i++)
+        {
+            const char* entry = frame.payload + 2 + i * STANDING_SIZE;
+            RacerInfo* racer = findRacer(getU16(entry));
+            if (racer != nullptr)
+            {
+                racer->progress = getProgress(entry + 2);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    case MSG_REJECT:
+        rejectReason.assign(frame.payload, frame.length);
+        return true;
+
+    default:
+        // 未知消息忽略，方便以后扩展协议
+        return false;
+    }
+}
+
+// 查找选手
+RacerInfo* RaceClient::findRacer(uint16_t id)
+{
+    for (RacerInfo& racer : racers)
+    {
+        if (racer.id == id)
+        {
+            return &racer;
+        }
+    }
+    return nullptr;
+}
+
+#ifdef __linux__
+
+// 连接主机
+bool RaceClient::connect(const string& socketPath, const string& name, string& error)
+{
+    disconnect();
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        error = "Socket path is too long.";
+        return false;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    // 本机连接立即完成；之后的收发都使用MSG_DONTWAIT，不会阻塞
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        error = (errno == ENOENT || errno == ECONNREFUSED) ? "No race is being hosted on this machine."
+                                                            : string("Unable to connect: ") + strerror(errno);
+        disconnect();
+        return false;
+    }
+
+    input.clear();
+    output.clear();
+    racerId = 0;
+    textReceived = false;
+    text.clear();
+    countdownStarted = false;
+    rejectReason.clear();
+    racers.clear();
+
+    payload.clear();
+    payload += static_cast<char>(VERSION);
+    payload.append(name, 0, MAX_NAME_BYTES);
+    appendFrame(output, MSG_HELLO, payload);
+    flush();
+    return isConnected();
+}
+
+// 断开连接
+void RaceClient::disconnect()
+{
+    if (fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// 处理所有已到达的消息
+bool RaceClient::poll()
+{
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    flush();
+
+    char buffer[4096];
+    bool closed = false;
+    while (fd >= 0)
+    {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received > 0)
+        {
+            input.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        closed = (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK));
+        break;
+    }
+
+    bool changed = false;
+    size_t offset = 0;
+    Frame frame;
+    while (nextFrame(input, offset, frame))
+    {
+        changed = handleFrame(frame) || changed;
+    }
+    input.erase(0, offset);
+
+    if (closed)
+    {
+        disconnect();
+        changed = true;
+    }
+    return changed;
+}
+
+// 发送自己的进度
+void RaceClient::sendProgress(const Progress& progress)
+{
+    if (fd < 0)
+    {
+        return;
+    }
+
+    payload.clear();
+    putProgress(payload, progress);
+    appendFrame(output, MSG_PROGRESS, payload);
+    flush();
+}
+
+// 发送缓存的数据
+void RaceClient::flush()
+{
+    size_t sent = 0;
+    while (sent < output.size())
+    {
+        ssize_t written = send(fd, output.data() + sent, output.size() - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (written > 0)
+        {
+            sent += static_cast<size_t>(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            output.clear();
+            disconnect();
+            return;
+        }
+        break;
+    }
+    output.erase(0, sent);
+}
+
+#else
+
+bool RaceClient::connect(const string&, const string&, string& error)
+{
+    error = "Race mode is only available on Linux.";
+    return false;
+}
+
+void RaceClient::disconnect()
+{
+}
+
+bool RaceClient::poll()
+{
+    return false;
+}
+
+void RaceClient::sendProgress(const Progress&)
+{
+}
+
+void RaceClient::flush()
+{
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef RACE_CLIENT_H
+#define RACE_CLIENT_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "race_protocol.h"
+
+// 比赛中的一名选手
+struct RacerInfo
+{
+    uint16_t id = 0;
+    std::string name;
+    RaceProtocol::Progress progress;
+    bool connected = true;  // 比赛开始后断开的选手保留在名单中
+};
+
+// 多人比赛的选手端
+// 连接主机后发送名字，接收比赛文本、名单、倒计时和其他选手的进度。
+// 套接字为非阻塞，练习循环每轮调用poll处理已到达的消息，不会阻塞输入
+class RaceClient
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    RaceClient() = default;
+    ~RaceClient();
+
+    // 连接主机并发送名字；失败时返回false，error为原因
+    bool connect(const std::string& socketPath, const std::string& name, std::string& error);
+
+    // 断开连接
+    void disconnect();
+
+    // 处理所有已到达的消息并发送缓存的数据，返回名单或进度是否有变化
+    bool poll();
+
+    // 发送自己的进度（进度消息很短，发送不完时缓存到下次poll）
+    void sendProgress(const RaceProtocol::Progress& progress);
+
+    bool isConnected() const { return fd >= 0; }
+
+    // 主机拒绝加入的原因，为空表示没有被拒绝
+    const std::string& getRejectReason() const { return rejectReason; }
+
+    // 主机分配的编号，0表示尚未加入
+    uint16_t getRacerId() const { return racerId; }
+
+    // 比赛文本
+    bool hasText() const { return textReceived; }
+    const std::string& getText() const { return text; }
+
+    // 倒计时：比赛开始的时间点
+    bool isCountdownStarted() const { return countdownStarted; }
+    TimePoint getStartTime() const { return startTime; }
+
+    // 所有选手（按加入顺序）
+    const std::vector<RacerInfo>& getRacers() const { return racers; }
+
+private:
+    // 处理一条消息，返回名单或进度是否有变化
+    bool handleFrame(const RaceProtocol::Frame& frame);
+
+    // 查找选手，不存在时返回nullptr
+    RacerInfo* findRacer(uint16_t id);
+
+    // 发送缓存的数据
+    void flush();
+
+    int fd = -1;
+    std::string input;
+    std::string output;
+    std::string payload;
+
+    uint16_t racerId = 0;
+    bool textReceived = false;
+    std::string text;
+    bool countdownStarted = false;
+    TimePoint startTime;
+    std::string rejectReason;
+    std::vector<RacerInfo> racers;
+};
+
+#endif // RACE_CLIENT_H
@@ -0,0 +1,83 @@
+#include "race_protocol.h"
+
+using namespace std;
+
+namespace RaceProtocol
+{
+    void putU16(string& out, uint16_t value)
+    {
+        out += static_cast<char>(value & 0xFF);
+        out += static_cast<char>(value >> 8);
+    }
+
+    void putU32(string& out, uint32_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            out += static_cast<char>((value >> shift) & 0xFF);
+        }
+    }
+
+    uint16_t getU16(const char* data)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+    uint32_t getU32(const char* data)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+               (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    // 追加一条消息，超长的负载被截断
+    void appendFrame(string& out, MessageType type, const string& payload)
+    {
+        size_t length = payload.size() < MAX_PAYLOAD ? payload.size() : MAX_PAYLOAD;
+        out += static_cast<char>(type);
+        putU16(out, static_cast<uint16_t>(length));
+        out.append(payload, 0, length);
+    }
+
+    void putProgress(string& out, const Progress& progress)
+    {
+        putU32(out, progress.position);
+        putU16(out, progress.wpmTenths);
+        putU16(out, progress.errors);
+        out += static_cast<char>(progress.flags);
+        putU32(out, progress.elapsedMs);
+    }
+
+    Progress getProgress(const char* data)
+    {
+        Progress progress;
+        progress.position = getU32(data);
+        progress.wpmTenths = getU16(data + 4);
+        progress.errors = getU16(data + 6);
+        progress.flags = static_cast<uint8_t>(data[8]);
+        progress.elapsedMs = getU32(data + 9);
+        return progress;
+    }
+
+    // 解析一条完整的消息
+    bool nextFrame(const string& buffer, size_t& offset, Frame& frame)
+    {
+        if (buffer.size() - offset < HEADER_SIZE)
+        {
+            return false;
+        }
+
+        size_t length = getU16(buffer.data() + offset + 1);
+        if (buffer.size() - offset - HEADER_SIZE < length)
+        {
+            return false;
+        }
+
+        frame.type = static_cast<MessageType>(buffer[offset]);
+        frame.payload = buffer.data() + offset + HEADER_SIZE;
+        frame.length = length;
+        offset += HEADER_SIZE + length;
+        return true;
+    }
+}
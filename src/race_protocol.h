@@ -0,0 +1,83 @@
+#ifndef RACE_PROTOCOL_H
+#define RACE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 多人比赛的二进制协议
+// 每条消息为 1字节类型 + 2字节负载长度（小端） + 负载，整数一律小端编码。
+// 进度消息只有13字节负载，主机每100ms只广播位置有变化的选手，
+// 因此50名以上选手同时比赛时每个连接的流量也只有几KB/秒
+namespace RaceProtocol
+{
+    const uint8_t VERSION = 1;
+
+    // 默认的Unix域套接字路径（同一台机器上的所有用户共享）
+    const char* const DEFAULT_SOCKET_PATH = "/tmp/typepractise-race.sock";
+
+    const size_t HEADER_SIZE = 3;
+    const size_t MAX_PAYLOAD = 65535;
+    const size_t MAX_TEXT_BYTES = 60000;   // 比赛文本的最大长度
+    const size_t MAX_NAME_BYTES = 24;      // 选手名字的最大长度
+
+    // 消息类型
+    enum MessageType : uint8_t
+    {
+        // 选手 -> 主机
+        MSG_HELLO = 1,        // u8 协议版本, 名字
+        MSG_PROGRESS = 2,     // u32 位置, u16 WPM*10, u16 错误数, u8 标志, u32 用时(ms)
+
+        // 主机 -> 选手
+        MSG_WELCOME = 16,     // u16 分配给该选手的编号
+        MSG_TEXT = 17,        // 比赛文本（UTF-8）
+        MSG_RACER = 18,       // u16 编号, 名字（有选手加入）
+        MSG_LEAVE = 19,       // u16 编号（选手断开）
+        MSG_COUNTDOWN = 20,   // u16 距离开始的毫秒数
+        MSG_STANDINGS = 21,   // u16 条数, 每条 u16 编号 + 进度消息的负载
+        MSG_REJECT = 22       // 拒绝原因
+    };
+
+    // 进度标志
+    const uint8_t PROGRESS_FINISHED = 0x01;
+
+    // 一名选手的进度
+    struct Progress
+    {
+        uint32_t position = 0;   // 已输入的字符数
+        uint16_t wpmTenths = 0;  // 速度（WPM * 10）
+        uint16_t errors = 0;     // 未改正的错误数
+        uint8_t flags = 0;
+        uint32_t elapsedMs = 0;  // 完成时为总用时
+    };
+
+    const size_t PROGRESS_SIZE = 13;
+    const size_t STANDING_SIZE = 2 + PROGRESS_SIZE;
+
+    // 解析出的一条消息（负载指向接收缓冲区）
+    struct Frame
+    {
+        MessageType type;
+        const char* payload;
+        size_t length;
+    };
+
+    // 整数编码
+    void putU16(std::string& out, uint16_t value);
+    void putU32(std::string& out, uint32_t value);
+    uint16_t getU16(const char* data);
+    uint32_t getU32(const char* data);
+
+    // 追加一条消息
+    void appendFrame(std::string& out, MessageType type, const std::string& payload);
+
+    // 进度负载
+    void putProgress(std::string& out, const Progress& progress);
+    Progress getProgress(const char* data);
+
+    // 从buffer的offset处解析一条完整的消息，成功时offset移到下一条消息；
+    // 数据不完整时返回false，offset不变
+    bool nextFrame(const std::string& buffer, size_t& offset, Frame& frame);
+}
+
+#endif // RACE_PROTOCOL_H
@@ -0,0 +1,595 @@
+#include "race_server.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace std::chrono;
+using namespace RaceProtocol;
+
+namespace
+{
+    const int MAX_EVENTS = 64;
+    const auto STANDINGS_INTERVAL = milliseconds(100);
+    const size_t MAX_PENDING_OUTPUT = 256 * 1024;  // 超过这么多数据发不出去的连接被断开
+}
+
+// 析构函数
+RaceServer::~RaceServer()
+{
+    stop();
+}
+
+#ifdef __linux__
+
+bool RaceServer::isSupported()
+{
+    return true;
+}
+
+// 开始监听
+bool RaceServer::start(const string& path, const string& raceText, string& error)
+{
+    if (worker.joinable())
+    {
+        error = "The race server is already running.";
+        return false;
+    }
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        error = "Socket path is too long.";
+        return false;
+    }
+    memcpy(address.sun_path, path.c_str(), path.size());
+
+    // 路径已存在时先尝试连接：能连上说明已有主机在运行，否则是上次异常退出留下的文件
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0)
+    {
+        bool inUse = (connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        close(probe);
+        if (inUse)
+        {
+            error = "Another race is already being hosted at " + path + ".";
+            return false;
+        }
+    }
+    unlink(path.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0)
+    {
+        error = "Unable to listen on " + path + ": " + strerror(errno);
+        if (listenFd >= 0)
+        {
+            close(listenFd);
+            listenFd = -1;
+        }
+        return false;
+    }
+
+    // 同一台机器上的其他用户也要能连接
+    chmod(path.c_str(), 0666);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0)
+    {
+        error = string("Unable to create event loop: ") + strerror(errno);
+        socketPath = path;
+        stop();
+        return false;
+    }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+
+    socketPath = path;
+    text = raceText.substr(0, MAX_TEXT_BYTES);
+    nextRacerId = 1;
+    raceStarted = false;
+    countdownRequest = 0;
+    stopping = false;
+    worker = thread(&RaceServer::run, this);
+    return true;
+}
+
+// 请求广播倒计时，由后台线程发送
+void RaceServer::startCountdown(int countdownMs)
+{
+    countdownRequest = max(countdownMs, 1);
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) < 0)
+    {
+        // 计数器溢出时唤醒事件已经在等待处理，忽略
+    }
+}
+
+// 停止后台线程并释放所有资源
+void RaceServer::stop()
+{
+    if (worker.joinable())
+    {
+        stopping = true;
+        uint64_t one = 1;
+        if (write(wakeFd, &one, sizeof(one)) < 0)
+        {
+            // 同上
+        }
+        worker.join();
+    }
+
+    for (auto& entry : connections)
+    {
+        close(entry.first);
+    }
+    connections.clear();
+    dropped.clear();
+
+    for (int* fd : {&listenFd, &epollFd, &wakeFd})
+    {
+        if (*fd >= 0)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+
+    if (!socketPath.empty())
+    {
+        unlink(socketPath.c_str());
+        socketPath.clear();
+    }
+}
+
+// 后台线程主循环
+void RaceServer::run()
+{
+    epoll_event events[MAX_EVENTS];
+    auto nextStandings = steady_clock::now();
+
+    while (!stopping)
+    {
+        // 比赛开始前只等待事件；开始后最多等到下一次广播进度
+        int timeoutMs = -1;
+        if (raceStarted)
+        {
+            auto now = steady_clock::now();
+            if (now >= nextStandings)
+            {
+                broadcastStandings();
+                closeDropped();
+                nextStandings = now + STANDINGS_INTERVAL;
+            }
+            timeoutMs = static_cast<int>(duration_cast<milliseconds>(nextStandings - now).count()) + 1;
+        }
+
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+        if (count < 0 && errno != EINTR)
+        {
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == listenFd)
+            {
+                acceptClients();
+                continue;
+            }
+
+            if (fd == wakeFd)
+            {
+                uint64_t value;
+                if (read(wakeFd, &value, sizeof(value)) < 0)
+                {
+                    // 非阻塞读取，没有数据时忽略
+                }
+
+                int countdownMs = countdownRequest.exchange(0);
+                if (countdownMs > 0 && !raceStarted)
+                {
+                    raceStarted = true;
+                    payload.clear();
+                    putU16(payload, static_cast<uint16_t>(min(countdownMs, 65535)));
+                    string message;
+                    appendFrame(message, MSG_COUNTDOWN, payload);
+                    broadcast(message);
+                    nextStandings = steady_clock::now();
+                }
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end() || it->second.dropped)
+            {
+                continue;
+            }
+
+            Connection& conn = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                dropConnection(conn);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT)
+            {
+                flush(conn);
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP))
+            {
+                readFrom(conn);
+            }
+        }
+
+        closeDropped();
+    }
+}
+
+// 接受所有等待中的连接
+void RaceServer::acceptClients()
+{
+    while (true)
+    {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            close(fd);
+            continue;
+        }
+
+        Connection& conn = connections[fd];
+        conn = Connection();
+        conn.fd = fd;
+    }
+}
+
+// 读取连接上的所有数据，逐条处理完整的消息
+void RaceServer::readFrom(Connection& conn)
+{
+    char buffer[4096];
+    while (true)
+    {
+        ssize_t received = recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (received > 0)
+        {
+            conn.input.append(buffer, static_cast<size_t>(received));
+            continue;
+        }
+        if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            dropConnection(conn);
+            return;
+        }
+        if (errno != EINTR)
+        {
+            break;
+        }
+    }
+
+    size_t offset = 0;
+    Frame frame;
+    while (!conn.dropped && !conn.closeAfterFlush && nextFrame(conn.input, offset, frame))
+    {
+        handleFrame(conn, frame);
+    }
+    conn.input.erase(0, offset);
+
+    // 选手只会发送很短的消息，缓冲区过大说明对方不是本程序
+    if (conn.input.size() > HEADER_SIZE + MAX_NAME_BYTES + 1)
+    {
+        dropConnection(conn);
+    }
+}
+
+// 处理一条消息
+void RaceServer::handleFrame(Connection& conn, const Frame& frame)
+{
+    string message;
+
+    if (frame.type == MSG_HELLO && conn.racerId == 0)
+    {
+        if (frame.length < 1 || static_cast<uint8_t>(frame.payload[0]) != VERSION)
+        {
+            appendFrame(message, MSG_REJECT, "Incompatible program version.");
+        }
+        else if (raceStarted)
+        {
+            appendFrame(message, MSG_REJECT, "The race has already started.");
+        }
+        else if (nextRacerId == 0xFFFF)
+        {
+            appendFrame(message, MSG_REJECT, "The race is full.");
+        }
+
+        if (!message.empty())
+        {
+            conn.closeAfterFlush = true;
+            sendTo(conn, message);
+            return;
+        }
+
+        conn.racerId = nextRacerId++;
+        conn.name.assign(frame.payload + 1, min(frame.length - 1, MAX_NAME_BYTES));
+
+        // 新选手：编号、文本和现有名单
+        payload.clear();
+        putU16(payload, conn.racerId);
+        appendFrame(message, MSG_WELCOME, payload);
+        appendFrame(message, MSG_TEXT, text);
+        for (const auto& entry : connections)
+        {
+            const Connection& other = entry.second;
+            if (other.racerId != 0 && &other != &conn && !other.dropped)
+            {
+                payload.clear();
+                putU16(payload, other.racerId);
+                payload += other.name;
+                appendFrame(message, MSG_RACER, payload);
+            }
+        }
+        sendTo(conn, message);
+
+        // 通知所有选手（包括新选手自己）
+        message.clear();
+        payload.clear();
+        putU16(payload, conn.racerId);
+        payload += conn.name;
+        appendFrame(message, MSG_RACER, payload);
+        broadcast(message);
+        return;
+    }
+
+    if (frame.type == MSG_PROGRESS && conn.racerId != 0 && raceStarted && frame.length >= PROGRESS_SIZE)
+    {
+        conn.progress = getProgress(frame.payload);
+        conn.dirty = true;
+    }
+}
+
+// 发送数据：先直接写入套接字，写不完的部分缓存起来等待可写事件
+void RaceServer::sendTo(Connection& conn, const string& data)
+{
+    if (conn.dropped)
+    {
+        return;
+    }
+
+    conn.output += data;
+    if (!conn.writing)
+    {
+        flush(conn);
+    }
+}
+
+// 尽量发送缓存的数据
+void RaceServer::flush(Connection& conn)
+{
+    size_t sent = 0;
+    while (sent < conn.output.size())
+    {
+        ssize_t written = ::send(conn.fd, conn.output.data() + sent, conn.output.size() - sent, MSG_NOSIGNAL);
+        if (written > 0)
+        {
+            sent += static_cast<size_t>(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            dropConnection(conn);
+            return;
+        }
+        break;
+    }
+    conn.output.erase(0, sent);
+
+    if (conn.output.size() > MAX_PENDING_OUTPUT)
+    {
+        dropConnection(conn);
+        return;
+    }
+
+    // 只有存在未发送的数据时才关注可写事件
+    bool wantWrite = !conn.output.empty();
+    if (wantWrite != conn.writing)
+    {
+        epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN | EPOLLRDHUP | (wantWrite ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.fd = conn.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &event);
+        conn.writing = wantWrite;
+    }
+
+    // 拒绝消息发送完后关闭
+    if (conn.closeAfterFlush && conn.output.empty())
+    {
+        dropConnection(conn);
+    }
+}
+
+// 发送给所有已加入的选手
+void RaceServer::broadcast(const string& data)
+{
+    for (auto& entry : connections)
+    {
+        Connection& conn = entry.second;
+        if (conn.racerId != 0 && !conn.dropped)
+        {
+            sendTo(conn, data);
+        }
+    }
+}
+
+// 把所有进度有变化的选手合并成一条消息广播
+void RaceServer::broadcastStandings()
+{
+    payload.clear();
+    putU16(payload, 0);
+    uint16_t count = 0;
+    for (auto& entry : connections)
+    {
+        Connection& conn = entry.second;
+        if (conn.dirty && payload.size() + STANDING_SIZE <= MAX_PAYLOAD)
+        {
+            putU16(payload, conn.racerId);
+            putProgress(payload, conn.progress);
+            conn.dirty = false;
+            count++;
+        }
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    payload[0] = static_cast<char>(count & 0xFF);
+    payload[1] = static_cast<char>(count >> 8);
+    string message;
+    appendFrame(message, MSG_STANDINGS, payload);
+    broadcast(message);
+}
+
+// 标记连接需要关闭
+void RaceServer::dropConnection(Connection& conn)
+{
+    if (!conn.dropped)
+    {
+        conn.dropped = true;
+        dropped.push_back(conn.fd);
+    }
+}
+
+// 关闭本轮标记的连接，已加入的选手离开时通知其他选手
+void RaceServer::closeDropped()
+{
+    while (!dropped.empty())
+    {
+        vector<int> closingFds;
+        closingFds.swap(dropped);
+
+        string message;
+        for (int fd : closingFds)
+        {
+            auto it = connections.find(fd);
+            if (it == connections.end())
+            {
+                continue;
+            }
+
+            if (it->second.racerId != 0)
+            {
+                payload.clear();
+                putU16(payload, it->second.racerId);
+                appendFrame(message, MSG_LEAVE, payload);
+            }
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            close(fd);
+            connections.erase(it);
+        }
+
+        // 广播本身可能再断开一些连接，循环直到没有新的断开
+        if (!message.empty())
+        {
+            broadcast(message);
+        }
+    }
+}
+
+#else
+
+// 其他平台没有epoll和Unix域套接字，比赛模式不可用
+bool RaceServer::isSupported()
+{
+    return false;
+}
+
+bool RaceServer::start(const string&, const string&, string& error)
+{
+    error = "Race mode is only available on Linux.";
+    return false;
+}
+
+void RaceServer::startCountdown(int)
+{
+}
+
+void RaceServer::stop()
+{
+}
+
+void RaceServer::run()
+{
+}
+
+void RaceServer::acceptClients()
+{
+}
+
+void RaceServer::readFrom(Connection&)
+{
+}
+
+void RaceServer::handleFrame(Connection&, const Frame&)
+{
+}
+
+void RaceServer::sendTo(Connection&, const string&)
+{
+}
+
+void RaceServer::flush(Connection&)
+{
+}
+
+void RaceServer::broadcast(const string&)
+{
+}
+
+void RaceServer::broadcastStandings()
+{
+}
+
+void RaceServer::dropConnection(Connection&)
+{
+}
+
+void RaceServer::closeDropped()
+{
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef RACE_SERVER_H
+#define RACE_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "race_protocol.h"
+
+// 多人比赛的主机
+// 在Unix域套接字上监听，后台线程用一个epoll循环处理所有连接：选手加入时发送比赛文本和名单，
+// 主机开始倒计时后不再接受新选手，比赛中每100ms把位置有变化的选手进度合并成一条消息广播。
+// 套接字全部为非阻塞，发送不完的数据缓存在连接中，等可写时再发送，
+// 单个慢速连接不会阻塞其他选手。只在Linux上可用
+class RaceServer
+{
+public:
+    RaceServer() = default;
+    ~RaceServer();
+
+    // 当前平台是否支持比赛模式
+    static bool isSupported();
+
+    // 开始监听并启动后台线程；失败时返回false，error为原因
+    bool start(const std::string& socketPath, const std::string& raceText, std::string& error);
+
+    // 向所有选手广播倒计时，countdownMs毫秒后比赛开始
+    void startCountdown(int countdownMs);
+
+    // 断开所有连接并停止后台线程
+    void stop();
+
+private:
+    // 一个选手连接
+    struct Connection
+    {
+        int fd = -1;
+        std::string input;                  // 尚未解析的数据
+        std::string output;                 // 尚未发送完的数据
+        uint16_t racerId = 0;               // 0表示尚未发送HELLO
+        std::string name;
+        RaceProtocol::Progress progress;
+        bool dirty = false;                 // 进度在上次广播后有变化
+        bool writing = false;               // 是否在等待可写事件
+        bool closeAfterFlush = false;       // 发送完剩余数据后关闭（拒绝加入时）
+        bool dropped = false;               // 已标记关闭
+    };
+
+    // 后台线程主循环
+    void run();
+
+    // 接受所有等待中的连接
+    void acceptClients();
+
+    // 读取连接上的数据并处理完整的消息
+    void readFrom(Connection& conn);
+    void handleFrame(Connection& conn, const RaceProtocol::Frame& frame);
+
+    // 发送数据，发送不完的部分缓存并等待可写事件
+    void sendTo(Connection& conn, const std::string& data);
+    void flush(Connection& conn);
+
+    // 发送给所有已加入的选手
+    void broadcast(const std::string& data);
+
+    // 广播进度有变化的选手
+    void broadcastStandings();
+
+    // 标记连接需要关闭，在本轮事件处理完后关闭
+    void dropConnection(Connection& conn);
+    void closeDropped();
+
+    std::string socketPath;
+    std::string text;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;    // 其他线程唤醒epoll循环用的eventfd
+
+    std::unordered_map<int, Connection> connections;  // 按文件描述符索引
+    std::vector<int> dropped;
+    uint16_t nextRacerId = 1;
+    bool raceStarted = false;
+    std::string payload;  // 组装消息负载用的缓冲区
+
+    std::atomic<int> countdownRequest{0};
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+};
+
+#endif // RACE_SERVER_H
@@ -0,0 +1,335 @@
+#include "session_history.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ctime>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using namespace std;
+
+namespace {
+
+// 历史文件头
+struct HistoryHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t byteOrder;     // 写入BYTE_ORDER_MARK，用于识别字节序不同的文件
+    uint32_t reserved;
+    int64_t createdAt;      // 创建时间（Unix时间，秒）
+    uint64_t reserved2;
+};
+
+static_assert(sizeof(HistoryHeader) == 32, "HistoryHeader is a file format");
+
+const char HISTORY_MAGIC[4] = {'T', 'P', 'S', 'H'};
+const uint16_t HISTORY_VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+const size_t HEADER_SIZE = sizeof(HistoryHeader);
+const size_t RECORD_SIZE = sizeof(SessionRecord);
+
+// 检查文件头是否属于本机可以直接映射的历史文件
+bool isValidHeader(const HistoryHeader& header)
+{
+    return memcmp(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC)) == 0 &&
+           header.version == HISTORY_VERSION &&
+           header.recordSize == RECORD_SIZE &&
+           header.byteOrder == BYTE_ORDER_MARK;
+}
+
+#ifdef _WIN32
+
+// 把整个文件只读映射到内存，空文件或失败时返回nullptr
+const char* mapReadOnly(const string& path, size_t& size)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    // 映射视图建立后即可关闭两个句柄，视图在UnmapViewOfFile之前一直有效
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        return nullptr;
+    }
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (address == nullptr)
+    {
+        return nullptr;
+    }
+
+    size = static_cast<size_t>(fileSize.QuadPart);
+    return static_cast<const char*>(address);
+}
+
+void unmapReadOnly(const char* address, size_t)
+{
+    UnmapViewOfFile(address);
+}
+
+#else
+
+// 把整个文件只读映射到内存，空文件或失败时返回nullptr
+const char* mapReadOnly(const string& path, size_t& size)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    // 映射建立后即可关闭文件描述符
+    void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    return static_cast<const char*>(address);
+}
+
+void unmapReadOnly(const char* address, size_t size)
+{
+    munmap(const_cast<char*>(address), size);
+}
+
+#endif
+
+} // namespace
+
+// 模式名称
+const char* practiceModeName(uint8_t mode)
+{
+    switch (mode)
+    {
+    case PRACTICE_MODE_TEXT:
+        return "Text";
+    case PRACTICE_MODE_ENDLESS:
+        return "Endless";
+    case PRACTICE_MODE_TIMED:
+        return "Timed";
+    case PRACTICE_MODE_GHOST:
+        return "Ghost";
+    case PRACTICE_MODE_RACE:
+        return "Race";
+    default:
+        return "Unknown";
+    }
+}
+
+// 析构函数
+SessionHistory::~SessionHistory()
+{
+    close();
+}
+
+// 设置历史文件路径
+void SessionHistory::setPath(const string& historyPath)
+{
+    close();
+    path = historyPath;
+}
+
+// 追加一条记录
+bool SessionHistory::append(const string& path, const SessionRecord& record)
+{
+    if (path.empty())
+    {
+        return false;
+    }
+
+    error_code ec;
+    uintmax_t fileSize = fs::exists(path, ec) ? fs::file_size(path, ec) : 0;
+    if (ec)
+    {
+        return false;
+    }
+
+    if (fileSize < HEADER_SIZE)
+    {
+        // 新文件（或只写了一半文件头的文件）：写入文件头和第一条记录
+        HistoryHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+        header.version = HISTORY_VERSION;
+        header.recordSize = static_cast<uint16_t>(RECORD_SIZE);
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.createdAt = static_cast<int64_t>(time(nullptr));
+
+        ofstream file(path, ios::binary | ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        return static_cast<bool>(file);
+    }
+
+    HistoryHeader header;
+    {
+        ifstream file(path, ios::binary);
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || !isValidHeader(header))
+        {
+            // 不认识的文件不追加，以免破坏其中的数据
+            return false;
+        }
+    }
+
+    // 截掉上次写入中途崩溃留下的不完整记录，保证记录边界对齐
+    uintmax_t tail = (fileSize - HEADER_SIZE) % RECORD_SIZE;
+    if (tail != 0)
+    {
+        fs::resize_file(path, fileSize - tail, ec);
+        if (ec)
+        {
+            return false;
+        }
+    }
+
+    ofstream file(path, ios::binary | ios::app);
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    return static_cast<bool>(file);
+}
+
+// 只读映射历史文件
+bool SessionHistory::open()
+{
+    close();
+
+    size_t fileSize = 0;
+    const char* address = mapReadOnly(path, fileSize);
+    if (address == nullptr)
+    {
+        return false;
+    }
+
+    mapped = address;
+    mappedSize = fileSize;
+    if (mappedSize < HEADER_SIZE + RECORD_SIZE || !isValidHeader(*reinterpret_cast<const HistoryHeader*>(mapped)))
+    {
+        close();
+        return false;
+    }
+
+    // 文件头32字节，映射地址按页对齐，记录数组满足对齐要求
+    recordData = reinterpret_cast<const SessionRecord*>(mapped + HEADER_SIZE);
+    recordCount = (mappedSize - HEADER_SIZE) / RECORD_SIZE;
+    return true;
+}
+
+// 解除映射
+void SessionHistory::close()
+{
+    if (mapped != nullptr)
+    {
+        unmapReadOnly(mapped, mappedSize);
+    }
+    mapped = nullptr;
+    mappedSize = 0;
+    recordData = nullptr;
+    recordCount = 0;
+}
+
+// 累加一条记录
+void HistorySummaryBuilder::add(const SessionRecord& record)
+{
+    if (summary.sessions == 0 || record.timestamp < summary.firstTimestamp)
+    {
+        summary.firstTimestamp = record.timestamp;
+    }
+    if (summary.sessions == 0 || record.timestamp > summary.lastTimestamp)
+    {
+        summary.lastTimestamp = record.timestamp;
+    }
+    if (record.netWPM > summary.bestNetWPM)
+    {
+        summary.bestNetWPM = record.netWPM;
+    }
+
+    summary.sessions++;
+    totalMs += record.durationMs;
+    summary.totalChars += record.charsTyped;
+    summary.totalCorrect += record.correctChars;
+    netWPMSum += record.netWPM;
+    accuracySum += record.accuracy;
+}
+
+// 计算平均值，得到汇总
+HistorySummary HistorySummaryBuilder::finish() const
+{
+    HistorySummary result = summary;
+    result.totalSeconds = totalMs / 1000.0;
+    if (result.sessions > 0)
+    {
+        result.averageNetWPM = netWPMSum / result.sessions;
+        result.averageAccuracy = accuracySum / result.sessions;
+    }
+    return result;
+}
+
+// 汇总一段记录
+HistorySummary SessionHistory::summarize(const SessionRecord* first, const SessionRecord* last)
+{
+    HistorySummaryBuilder builder;
+    for (const SessionRecord* record = first; record != last; ++record)
+    {
+        builder.add(*record);
+    }
+    return builder.finish();
+}
+
+// 统计文件对应的历史文件路径：替换扩展名为.history
+string SessionHistory::pathForStats(const string& statsPath)
+{
+    size_t dot = statsPath.find_last_of('.');
+    size_t separator = statsPath.find_last_of("\\/");
+    if (dot == string::npos || (separator != string::npos && dot < separator))
+    {
+        return statsPath + ".history";
+    }
+    return statsPath.substr(0, dot) + ".history";
+}
+
+// 语料编号
+uint32_t SessionHistory::corpusId(const string& corpusPath)
+{
+    size_t separator = corpusPath.find_last_of("\\/");
+    size_t start = (separator == string::npos) ? 0 : separator + 1;
+
+    uint32_t hash = 2166136261u;
+    for (size_t i = start; i < corpusPath.size(); i++)
+    {
+        hash ^= static_cast<unsigned char>(corpusPath[i]);
+        hash *= 16777619u;
+    }
+    return hash != 0 ? hash : 1;
+}
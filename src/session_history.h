@@ -0,0 +1,120 @@
+#ifndef SESSION_HISTORY_H
+#define SESSION_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// 练习模式（写入历史记录，数值不能改变）
+enum PracticeMode : uint8_t
+{
+    PRACTICE_MODE_TEXT = 0,     // 普通文本练习
+    PRACTICE_MODE_ENDLESS = 1,  // 无尽模式
+    PRACTICE_MODE_TIMED = 2,    // 限时测试
+    PRACTICE_MODE_GHOST = 3,    // 与个人最佳比赛
+    PRACTICE_MODE_RACE = 4      // 多人比赛
+};
+
+// 模式名称（用于显示）
+const char* practiceModeName(uint8_t mode);
+
+// 一次练习的历史记录
+// 固定48字节、字段自然对齐，文件映射到内存后可以直接按数组访问，不需要解析
+struct SessionRecord
+{
+    int64_t timestamp = 0;     // 练习结束的时间（Unix时间，秒）
+    uint32_t corpusId = 0;     // 语料编号（语料文件名的哈希），0表示自定义或混合文本
+    uint32_t durationMs = 0;   // 计入成绩的用时
+    uint32_t charsTyped = 0;
+    uint32_t correctChars = 0;
+    float rawWPM = 0.0f;
+    float netWPM = 0.0f;
+    float accuracy = 0.0f;     // 百分比
+    uint8_t mode = PRACTICE_MODE_TEXT;
+    uint8_t difficulty = 0;    // DifficultyLevel
+    uint16_t flags = 0;        // 保留
+    uint8_t reserved[8] = {};
+};
+
+static_assert(sizeof(SessionRecord) == 48, "SessionRecord is a file format");
+static_assert(std::is_trivially_copyable<SessionRecord>::value, "SessionRecord is read from a mapped file");
+
+// 一组历史记录的汇总
+struct HistorySummary
+{
+    size_t sessions = 0;
+    int64_t firstTimestamp = 0;
+    int64_t lastTimestamp = 0;
+    double totalSeconds = 0.0;
+    uint64_t totalChars = 0;
+    uint64_t totalCorrect = 0;
+    double averageNetWPM = 0.0;    // 各次练习净速度的平均值
+    double bestNetWPM = 0.0;
+    double averageAccuracy = 0.0;  // 各次练习准确率的平均值
+};
+
+// 逐条累加记录得到汇总，记录不必连续（查询结果也用它汇总）
+class HistorySummaryBuilder
+{
+public:
+    void add(const SessionRecord& record);
+    HistorySummary finish() const;
+
+private:
+    HistorySummary summary;
+    uint64_t totalMs = 0;
+    double netWPMSum = 0.0;
+    double accuracySum = 0.0;
+};
+
+// 每个用户的练习历史
+// 文件为 32字节文件头 | 记录数组，每次练习结束追加一条记录，已有内容从不改写。
+// 读取时把整个文件只读映射到内存，十万条记录（约4.8MB）的汇总只是一次顺序扫描。
+// 记录按本机字节序保存，文件头中的字节序标记与本机不同时拒绝读取；
+// 写入中途崩溃留下的不完整记录在下次追加前截掉
+class SessionHistory
+{
+public:
+    SessionHistory() = default;
+    ~SessionHistory();
+
+    SessionHistory(const SessionHistory&) = delete;
+    SessionHistory& operator=(const SessionHistory&) = delete;
+
+    // 设置历史文件路径（会关闭已打开的映射）
+    void setPath(const std::string& historyPath);
+    const std::string& getPath() const { return path; }
+
+    // 向historyPath追加一条记录，文件不存在时创建
+    // 只访问文件，不涉及映射，可以在后台写入线程中调用
+    static bool append(const std::string& historyPath, const SessionRecord& record);
+
+    // 只读映射历史文件（已打开时重新映射，以包含之后追加的记录）
+    // 文件不存在、为空或格式不符时返回false
+    bool open();
+    void close();
+
+    // 已映射的记录，按追加顺序（即时间顺序）排列
+    const SessionRecord* records() const { return recordData; }
+    size_t size() const { return recordCount; }
+
+    // 汇总[first, last)范围内的记录
+    static HistorySummary summarize(const SessionRecord* first, const SessionRecord* last);
+
+    // 统计文件对应的历史文件路径
+    static std::string pathForStats(const std::string& statsPath);
+
+    // 语料编号：语料文件名（不含目录）的32位FNV-1a哈希，0保留给非语料文本
+    static uint32_t corpusId(const std::string& corpusPath);
+
+private:
+    std::string path;
+
+    const char* mapped = nullptr;
+    size_t mappedSize = 0;
+    const SessionRecord* recordData = nullptr;
+    size_t recordCount = 0;
+};
+
+#endif // SESSION_HISTORY_H
@@ -0,0 +1,801 @@
+#include "session_replay.h"
+#include "session_view.h"
+#include "gui_helper.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <ctime>
+
+namespace fs = std::filesystem;
+using namespace std;
+using namespace std::chrono;
+using namespace GUIHelper;
+
+namespace {
+
+const char REPLAY_MAGIC[4] = {'T', 'P', 'R', 'L'};
+const uint8_t REPLAY_VERSION = 2;          // 版本2在文件头中记录用时
+const uint8_t REPLAY_VERSION_NO_DURATION = 1;
+const size_t REPLAY_HEADER_SIZE = sizeof(REPLAY_MAGIC) + 2 + 16;  // 用时之前的部分
+const uint8_t REPLAY_FLAG_SKIP_SPACE = 0x01;
+const uint8_t REPLAY_FLAG_IGNORE_CASE = 0x02;
+const uint8_t REPLAY_FLAG_STOP_ON_ERROR = 0x04;
+const uint8_t REPLAY_FLAG_MUST_CORRECT = 0x08;
+
+// 写入无符号LEB128变长整数
+void writeVarint(string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+// 读取无符号LEB128变长整数
+bool readVarint(const string& in, size_t& pos, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+    {
+        uint8_t byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 以小端序写入固定宽度整数
+void writeFixed64(string& out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void writeFixed32(string& out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+// 以小端序读取固定宽度整数
+uint32_t readFixed32(const string& in, size_t pos)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+    }
+    return value;
+}
+
+uint64_t readFixed64(const string& in, size_t pos)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+    }
+    return value;
+}
+
+// 读取整个文件
+bool readWholeFile(const string& path, string& content, size_t maxBytes = 0)
+{
+    ifstream file(path, ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    if (maxBytes > 0)
+    {
+        content.resize(maxBytes);
+        file.read(&content[0], maxBytes);
+        content.resize(static_cast<size_t>(file.gcount()));
+    }
+    else
+    {
+        content.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    }
+    return true;
+}
+
+// 哈希值转为十六进制文件名
+string hashToHex(uint64_t hash)
+{
+    char buffer[17];
+    snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+} // namespace
+
+// 构造函数
+ReplayManager::ReplayManager()
+{
+}
+
+// 析构函数
+ReplayManager::~ReplayManager()
+{
+    // 写完排队的回放再退出
+    writer.stop();
+}
+
+// 设置回放目录
+void ReplayManager::setReplayDir(const string& dir)
+{
+    waitForWriter();
+    replayDir = dir;
+    replayList.clear();
+    replayIndex.clear();
+    replayListLoaded = false;
+    lastSuffix = -1;
+}
+
+// 等待写入线程
+void ReplayManager::waitForWriter() const
+{
+    if (!writer.flush())
+    {
+        saveFailed = true;
+    }
+}
+
+// 等待所有排队的回放写完
+bool ReplayManager::flush()
+{
+    waitForWriter();
+    bool succeeded = !saveFailed;
+    saveFailed = false;
+    return succeeded;
+}
+
+// 计算文本哈希
+uint64_t ReplayManager::hashText(const string& text)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 文本存储路径
+string ReplayManager::getTextPath(uint64_t textHash) const
+{
+    return replayDir + "\\texts\\" + hashToHex(textHash) + ".txt";
+}
+
+// 保存一次完成的练习
+bool ReplayManager::saveSession(const TypingSession& session)
+{
+    if (replayDir.empty())
+    {
+        return false;
+    }
+
+    const KeystrokeLog& log = session.getKeyLog();
+    string text = session.getTextUtf8();
+    uint64_t textHash = hashText(text);
+    int64_t recordedAt = static_cast<int64_t>(time(nullptr));
+
+    // 编码事件：暂停事件不写入回放，暂停的时间从之后的事件时间中扣除
+    string events;
+    events.reserve(log.size() * 3);
+    uint32_t eventCount = 0;
+    uint64_t previousMs = 0;
+    int64_t pausedNs = 0;
+    int64_t pauseStartNs = 0;
+    for (size_t i = 0; i < log.size(); i++)
+    {
+        if (log.kind(i) == KEYSTROKE_PAUSE)
+        {
+            pauseStartNs = log.timeNs(i);
+            continue;
+        }
+        if (log.kind(i) == KEYSTROKE_RESUME)
+        {
+            pausedNs += log.timeNs(i) - pauseStartNs;
+            continue;
+        }
+
+        uint64_t timeMs = static_cast<uint64_t>(max<int64_t>(0, (log.timeNs(i) - pausedNs) / 1000000));
+        writeVarint(events, timeMs - min(timeMs, previousMs));
+        previousMs = max(timeMs, previousMs);
+
+        uint32_t key = (log.kind(i) == KEYSTROKE_BACKSPACE)
+                           ? REPLAY_KEY_BACKSPACE
+                           : static_cast<uint32_t>(log.typed(i));
+        writeVarint(events, key);
+        eventCount++;
+    }
+
+    // 文件头
+    string out;
+    out.reserve(REPLAY_HEADER_SIZE + 16 + events.size());
+    out.append(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    out += static_cast<char>(REPLAY_VERSION);
+
+    uint8_t flags = 0;
+    if (session.isSkipSpace())
+    {
+        flags |= REPLAY_FLAG_SKIP_SPACE;
+    }
+    if (session.isIgnoreCase())
+    {
+        flags |= REPLAY_FLAG_IGNORE_CASE;
+    }
+    if (session.getStrictMode() == STRICT_STOP_ON_ERROR)
+    {
+        flags |= REPLAY_FLAG_STOP_ON_ERROR;
+    }
+    else if (session.getStrictMode() == STRICT_MUST_CORRECT)
+    {
+        flags |= REPLAY_FLAG_MUST_CORRECT;
+    }
+    out += static_cast<char>(flags);
+
+    uint32_t durationMs = static_cast<uint32_t>(previousMs);
+    writeFixed64(out, textHash);
+    writeFixed64(out, static_cast<uint64_t>(recordedAt));
+    writeFixed32(out, durationMs);
+    writeVarint(out, eventCount);
+    out += events;
+
+    string path;
+    try
+    {
+        fs::create_directories(replayDir + "\\texts");
+
+        // 同一文本只保存一份（排队中的同一文本内容相同，重复提交会被合并）
+        string textPath = getTextPath(textHash);
+        if (!fs::exists(textPath))
+        {
+            writer.replace(textPath, text);
+        }
+
+        // 文件名：录制时间_文本哈希，同一秒内的多次练习追加序号
+        string basePath = replayDir + "\\" + to_string(recordedAt) + "_" + hashToHex(textHash).substr(0, 8);
+        int suffix = (recordedAt == lastSavedAt) ? lastSuffix + 1 : 0;
+        path = (suffix == 0) ? basePath + ".tpr" : basePath + "_" + to_string(suffix) + ".tpr";
+        while (fs::exists(path))
+        {
+            path = basePath + "_" + to_string(++suffix) + ".tpr";
+        }
+        lastSavedAt = recordedAt;
+        lastSuffix = suffix;
+    }
+    catch (const fs::filesystem_error&)
+    {
+        return false;
+    }
+
+    writer.replace(path, move(out));
+
+    // 缓存已建立时直接加入，否则下次扫描目录时会读到
+    if (replayListLoaded)
+    {
+        ReplayInfo info;
+        info.path = path;
+        info.textHash = textHash;
+        info.recordedAt = recordedAt;
+        info.eventCount = eventCount;
+        info.durationMs = durationMs;
+        addToReplayList(info);
+    }
+
+    // 之前排队的写入失败时报告一次
+    string error;
+    if (writer.takeError(error))
+    {
+        saveFailed = true;
+    }
+    bool succeeded = !saveFailed;
+    saveFailed = false;
+    return succeeded;
+}
+
+// 读取回放文件
+bool ReplayManager::readReplayFile(const string& path, ReplayData& data, uint32_t& eventCount, bool withText) const
+{
+    string content;
+    if (!readWholeFile(path, content) || content.size() < REPLAY_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    uint8_t version = static_cast<uint8_t>(content[4]);
+    if (!equal(REPLAY_MAGIC, REPLAY_MAGIC + sizeof(REPLAY_MAGIC), content.begin()) ||
+        (version != REPLAY_VERSION && version != REPLAY_VERSION_NO_DURATION))
+    {
+        return false;
+    }
+
+    uint8_t flags = static_cast<uint8_t>(content[5]);
+    data.skipSpace = (flags & REPLAY_FLAG_SKIP_SPACE) != 0;
+    data.ignoreCase = (flags & REPLAY_FLAG_IGNORE_CASE) != 0;
+    data.strictMode = (flags & REPLAY_FLAG_STOP_ON_ERROR) ? STRICT_STOP_ON_ERROR
+                      : (flags & REPLAY_FLAG_MUST_CORRECT) ? STRICT_MUST_CORRECT
+                                                           : STRICT_OFF;
+    data.textHash = readFixed64(content, 6);
+    data.recordedAt = static_cast<int64_t>(readFixed64(content, 14));
+
+    // 用时可以从事件中算出，读取完整文件时跳过
+    size_t pos = REPLAY_HEADER_SIZE;
+    if (version == REPLAY_VERSION)
+    {
+        if (content.size() < pos + 4)
+        {
+            return false;
+        }
+        pos += 4;
+    }
+    uint64_t count;
+    if (!readVarint(content, pos, count))
+    {
+        return false;
+    }
+
+    // 每个事件至少占两个字节，超出剩余长度的数量来自损坏的文件，不能用来预分配
+    if (count > (content.size() - pos) / 2)
+    {
+        return false;
+    }
+    eventCount = static_cast<uint32_t>(count);
+
+    data.timesMs.clear();
+    data.keys.clear();
+    data.timesMs.reserve(eventCount);
+    data.keys.reserve(eventCount);
+
+    // 解码事件（列表显示时也需要累计时长）
+    uint64_t timeMs = 0;
+    for (uint32_t i = 0; i < eventCount; i++)
+    {
+        uint64_t delta, key;
+        if (!readVarint(content, pos, delta) || !readVarint(content, pos, key))
+        {
+            return false;
+        }
+        timeMs += delta;
+        data.timesMs.push_back(static_cast<uint32_t>(timeMs));
+        data.keys.push_back(static_cast<uint32_t>(key));
+    }
+
+    if (withText)
+    {
+        if (!readWholeFile(getTextPath(data.textHash), data.text) || hashText(data.text) != data.textHash)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// 只读取回放文件头
+bool ReplayManager::readReplayInfo(const string& path, ReplayInfo& info) const
+{
+    // 固定部分、用时和最长10字节的事件数
+    string header;
+    if (!readWholeFile(path, header, REPLAY_HEADER_SIZE + 4 + 10) || header.size() < REPLAY_HEADER_SIZE ||
+        !equal(REPLAY_MAGIC, REPLAY_MAGIC + sizeof(REPLAY_MAGIC), header.begin()))
+    {
+        return false;
+    }
+
+    uint8_t version = static_cast<uint8_t>(header[4]);
+    if (version == REPLAY_VERSION_NO_DURATION)
+    {
+        ReplayData data;
+        if (!readReplayFile(path, data, info.eventCount, false))
+        {
+            return false;
+        }
+        info.path = path;
+        info.textHash = data.textHash;
+        info.recordedAt = data.recordedAt;
+        info.durationMs = data.timesMs.empty() ? 0 : data.timesMs.back();
+        return true;
+    }
+    if (version != REPLAY_VERSION || header.size() < REPLAY_HEADER_SIZE + 4)
+    {
+        return false;
+    }
+
+    size_t pos = REPLAY_HEADER_SIZE + 4;
+    uint64_t count;
+    if (!readVarint(header, pos, count) || count > UINT32_MAX)
+    {
+        return false;
+    }
+
+    info.path = path;
+    info.textHash = readFixed64(header, 6);
+    info.recordedAt = static_cast<int64_t>(readFixed64(header, 14));
+    info.durationMs = readFixed32(header, REPLAY_HEADER_SIZE);
+    info.eventCount = static_cast<uint32_t>(count);
+    return true;
+}
+
+// 扫描回放目录建立缓存
+void ReplayManager::loadReplayList() const
+{
+    if (replayListLoaded)
+    {
+        return;
+    }
+
+    waitForWriter();
+    replayList.clear();
+    replayIndex.clear();
+    replayListLoaded = true;
+    if (replayDir.empty() || !fs::exists(replayDir))
+    {
+        return;
+    }
+
+    try
+    {
+        for (const auto& entry : fs::directory_iterator(replayDir))
+        {
+            if (!entry.is_regular_file() || entry.path().extension() != ".tpr")
+            {
+                continue;
+            }
+
+            ReplayInfo info;
+            if (readReplayInfo(entry.path().string(), info))
+            {
+                addToReplayList(info);
+            }
+        }
+    }
+    catch (const fs::filesystem_error&)
+    {
+        // 保留已读到的部分
+    }
+}
+
+// 加入缓存
+void ReplayManager::addToReplayList(const ReplayInfo& info) const
+{
+    replayIndex[info.textHash].push_back(replayList.size());
+    replayList.push_back(info);
+}
+
+// 加载回放
+bool ReplayManager::loadReplay(const string& path, ReplayData& data) const
+{
+    waitForWriter();
+    uint32_t eventCount;
+    return readReplayFile(path, data, eventCount, true);
+}
+
+// 列出所有回放
+vector<ReplayInfo> ReplayManager::listReplays() const
+{
+    loadReplayList();
+
+    vector<ReplayInfo> sorted = replayList;
+    stable_sort(sorted.begin(), sorted.end(),
+                [](const ReplayInfo& a, const ReplayInfo& b)
+                {
+                    return a.recordedAt > b.recordedAt;
+                });
+    return sorted;
+}
+
+// 查找个人最佳回放：按用时从短到长依次加载，取第一个完整输入了文本的回放
+bool ReplayManager::findBestReplay(const string& text, ReplayData& data) const
+{
+    loadReplayList();
+
+    auto found = replayIndex.find(hashText(text));
+    if (found == replayIndex.end())
+    {
+        return false;
+    }
+
+    vector<const ReplayInfo*> candidates;
+    for (size_t index : found->second)
+    {
+        if (replayList[index].eventCount > 0)
+        {
+            candidates.push_back(&replayList[index]);
+        }
+    }
+
+    sort(candidates.begin(), candidates.end(),
+         [](const ReplayInfo* a, const ReplayInfo* b)
+         {
+             return a->durationMs < b->durationMs;
+         });
+
+    for (const ReplayInfo* info : candidates)
+    {
+        if (loadReplay(info->path, data) && data.text == text && GhostTimeline(data).isComplete())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 回放选择界面
+void ReplayManager::showReplayBrowser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin)
+{
+    vector<ReplayInfo> replays = listReplays();
+    if (replays.empty())
+    {
+        showMessageDialog(headerWin, contentWin, statusWin,
+                          "No session replays yet. Complete a practice session first.",
+                          DIALOG_INFO, "Session Replays");
+        return;
+    }
+
+    int selectedIndex = 0;
+    while (true)
+    {
+        updateHeaderWindow(headerWin, "SESSION REPLAYS");
+        clearContentWindow(contentWin);
+
+        int itemsPerPage = max(1, getmaxy(contentWin) - 8);
+        int startIdx = (selectedIndex / itemsPerPage) * itemsPerPage;
+        int endIdx = min(startIdx + itemsPerPage, static_cast<int>(replays.size()));
+
+        wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+        mvwprintw(contentWin, 1, 2, "Recorded sessions (%zu):", replays.size());
+        wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+
+        wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+        for (int i = startIdx; i < endIdx; i++)
+        {
+            const ReplayInfo& info = replays[i];
+            time_t recordedAt = static_cast<time_t>(info.recordedAt);
+            char timeText[32];
+            strftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S", localtime(&recordedAt));
+
+            if (i == selectedIndex)
+            {
+                wattron(contentWin, A_REVERSE);
+            }
+            mvwprintw(contentWin, 3 + (i - startIdx), 2, "%d. %s  %u keys  %.1f s",
+                      i + 1, timeText, info.eventCount, info.durationMs / 1000.0);
+            if (i == selectedIndex)
+            {
+                wattroff(contentWin, A_REVERSE);
+            }
+        }
+
+        mvwprintw(contentWin, getmaxy(contentWin) - 3, 2, "UP/DOWN: Move   Enter: Play   ESC: Return");
+        wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+
+        updateStatusWindowWithHelp(statusWin, "Select a session to replay", "ESC to return");
+        wrefresh(contentWin);
+
+        int ch = getch();
+        switch (ch)
+        {
+        case KEY_RESIZE:
+            // 终端大小改变，下一轮按新尺寸重绘
+            resizeWindows(headerWin, contentWin, statusWin);
+            break;
+
+        case KEY_UP:
+            if (selectedIndex > 0)
+            {
+                selectedIndex--;
+            }
+            break;
+
+        case KEY_DOWN:
+            if (selectedIndex < static_cast<int>(replays.size()) - 1)
+            {
+                selectedIndex++;
+            }
+            break;
+
+        case '\n':
+        case '\r':
+        case KEY_ENTER:
+        {
+            ReplayData data;
+            if (loadReplay(replays[selectedIndex].path, data))
+            {
+                playReplay(headerWin, contentWin, statusWin, data);
+            }
+            else
+            {
+                showMessageDialog(headerWin, contentWin, statusWin,
+                                  "This replay file is damaged or its text is missing.",
+                                  DIALOG_ERROR, "Error");
+            }
+            break;
+        }
+
+        case KEY_ESC:
+            return;
+        }
+    }
+}
+
+// 播放回放：按录制的时间重新输入到会话中，并用练习界面的渲染器显示
+void ReplayManager::playReplay(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin, const ReplayData& data)
+{
+    const int SPEEDS[] = {1, 2, 4, 8, 16};
+    const int SPEED_COUNT = sizeof(SPEEDS) / sizeof(SPEEDS[0]);
+    int speedIndex = 0;
+    bool paused = false;
+
+    updateHeaderWindow(headerWin, "SESSION REPLAY");
+    clearContentWindow(contentWin);
+
+    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+    mvwprintw(contentWin, 2, 2, "Replaying recorded session:");
+    wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+
+    // 会话的时间轴使用回放时间，实时统计与录制时一致
+    auto sessionStart = steady_clock::now();
+    TypingSession session;
+    session.setStrictMode(data.strictMode);
+    session.start(data.text, data.skipSpace, data.ignoreCase, sessionStart);
+
+    SessionView view(contentWin, 4, 2);
+    view.layout(session, getmaxx(contentWin) - 6);
+    view.drawAll(session);
+    session.clearDirty();
+    view.refresh();
+
+    double replayMs = 0;
+    auto lastRealTime = steady_clock::now();
+    size_t nextEvent = 0;
+
+    while (true)
+    {
+        auto now = steady_clock::now();
+        if (!paused)
+        {
+            replayMs += duration<double, milli>(now - lastRealTime).count() * SPEEDS[speedIndex];
+        }
+        lastRealTime = now;
+
+        // 应用所有已到时间的事件
+        while (nextEvent < data.keys.size() && data.timesMs[nextEvent] <= replayMs)
+        {
+            auto eventTime = sessionStart + milliseconds(data.timesMs[nextEvent]);
+            if (data.keys[nextEvent] == REPLAY_KEY_BACKSPACE)
+            {
+                session.backspace(eventTime);
+            }
+            else
+            {
+                session.typeChar(static_cast<char32_t>(data.keys[nextEvent]), eventTime);
+            }
+            nextEvent++;
+        }
+
+        view.drawDirty(session);
+        view.refresh();
+
+        bool finished = nextEvent >= data.keys.size();
+        string status = session.getLiveStats().formatStatusLine(
+            sessionStart + milliseconds(static_cast<int64_t>(replayMs)),
+            static_cast<int>(session.getPosition() * 100 / max<size_t>(1, session.getText().size())),
+            session.getScore());
+        status += "  x" + to_string(SPEEDS[speedIndex]);
+        if (paused)
+        {
+            status += " (paused)";
+        }
+        else if (finished)
+        {
+            status += " (end)";
+        }
+        updateStatusWindowWithHelp(statusWin, status, "+/-: Speed  Space: Pause  ESC: Exit");
+
+        // 等到下一个事件或下一次状态刷新
+        int waitMs = 100;
+        if (!paused && !finished)
+        {
+            double untilNext = (data.timesMs[nextEvent] - replayMs) / SPEEDS[speedIndex];
+            waitMs = max(1, min(waitMs, static_cast<int>(untilNext) + 1));
+        }
+        else if (finished)
+        {
+            waitMs = -1;
+        }
+
+        timeout(waitMs);
+        int ch = getch();
+        timeout(-1);
+
+        if (ch == KEY_RESIZE)
+        {
+            // 终端大小改变：按新宽度重新断行，回放进度保留
+            resizeWindows(headerWin, contentWin, statusWin);
+            wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+            mvwprintw(contentWin, 2, 2, "Replaying recorded session:");
+            wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+            view.resize(session, getmaxx(contentWin) - 6);
+            view.drawAll(session);
+            session.clearDirty();
+        }
+        else if (ch == KEY_ESC || (finished && ch != ERR && ch != ' ' && ch != '+' && ch != '-'))
+        {
+            break;
+        }
+        else if (ch == '+' || ch == '=')
+        {
+            speedIndex = min(speedIndex + 1, SPEED_COUNT - 1);
+        }
+        else if (ch == '-')
+        {
+            speedIndex = max(speedIndex - 1, 0);
+        }
+        else if (ch == ' ')
+        {
+            paused = !paused;
+        }
+    }
+}
+
+// 构造幽灵时间轴：按回放的设置重新输入一遍，记录每个事件之后的位置
+GhostTimeline::GhostTimeline(const ReplayData& data)
+{
+    auto start = steady_clock::now();
+    TypingSession session;
+    session.setStrictMode(data.strictMode);
+    session.start(data.text, data.skipSpace, data.ignoreCase, start);
+
+    timesMs.reserve(data.keys.size());
+    positions.reserve(data.keys.size());
+    for (size_t i = 0; i < data.keys.size(); i++)
+    {
+        auto eventTime = start + milliseconds(data.timesMs[i]);
+        if (data.keys[i] == REPLAY_KEY_BACKSPACE)
+        {
+            session.backspace(eventTime);
+        }
+        else if (!session.isFinished())
+        {
+            session.typeChar(static_cast<char32_t>(data.keys[i]), eventTime);
+        }
+
+        timesMs.push_back(data.timesMs[i]);
+        positions.push_back(static_cast<uint32_t>(session.getPosition()));
+    }
+    complete = session.isFinished();
+}
+
+// 二分查找最后一个不晚于elapsedMs的事件
+size_t GhostTimeline::positionAt(int64_t elapsedMs) const
+{
+    if (elapsedMs < 0)
+    {
+        return 0;
+    }
+
+    auto it = upper_bound(timesMs.begin(), timesMs.end(), static_cast<uint64_t>(elapsedMs),
+                          [](uint64_t value, uint32_t time)
+                          {
+                              return value < time;
+                          });
+    if (it == timesMs.begin())
+    {
+        return 0;
+    }
+    return positions[(it - timesMs.begin()) - 1];
+}
@@ -0,0 +1,136 @@
+#ifndef SESSION_REPLAY_H
+#define SESSION_REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <curses.h>
+#include "async_file_writer.h"
+#include "typing_session.h"
+
+// 回放文件中表示退格的按键码
+const uint32_t REPLAY_KEY_BACKSPACE = 8;
+
+// 回放文件概要（用于列表显示）
+struct ReplayInfo
+{
+    std::string path;
+    uint64_t textHash = 0;
+    int64_t recordedAt = 0;     // 录制时间（Unix时间，秒）
+    uint32_t eventCount = 0;
+    uint32_t durationMs = 0;
+};
+
+// 完整的回放数据
+struct ReplayData
+{
+    uint64_t textHash = 0;
+    int64_t recordedAt = 0;
+    bool skipSpace = true;
+    bool ignoreCase = false;
+    StrictMode strictMode = STRICT_OFF;
+    std::string text;
+    std::vector<uint32_t> timesMs;  // 每个按键距练习开始的毫秒数
+    std::vector<uint32_t> keys;     // 按键码（字符的Unicode码位或REPLAY_KEY_BACKSPACE）
+};
+
+// 幽灵对手的时间轴：回放中每个事件之后的光标位置
+// 构造时用回放数据模拟一遍输入，练习过程中按经过的时间二分查找位置
+class GhostTimeline
+{
+public:
+    GhostTimeline() {}
+    explicit GhostTimeline(const ReplayData& data);
+
+    bool isEmpty() const { return timesMs.empty(); }
+
+    // 回放是否输入完了全部文本
+    bool isComplete() const { return complete; }
+
+    // 完成全部文本的用时（毫秒）
+    uint32_t getDurationMs() const { return timesMs.empty() ? 0 : timesMs.back(); }
+
+    // 练习开始elapsedMs毫秒后幽灵所在的文本位置
+    size_t positionAt(int64_t elapsedMs) const;
+
+private:
+    std::vector<uint32_t> timesMs;
+    std::vector<uint32_t> positions;
+    bool complete = false;
+};
+
+// 练习回放管理器
+// 每次练习保存为一个紧凑的二进制文件：
+//   "TPRL" | 版本(1) | 标志(1) | 文本哈希(8) | 录制时间(8) | 用时毫秒(4) | 事件数(varint)
+//   之后每个事件为 时间增量毫秒(varint) | 按键码(varint)
+// 正常打字时每个按键约占2~3字节。练习文本按哈希单独保存一份，同一文本的多次练习共用。
+// 回放在内存中编码后交给后台线程原子地写入；回放列表只读取文件头，第一次使用时建立后
+// 缓存在内存中（按文本哈希索引），之后保存的回放直接加入缓存
+class ReplayManager
+{
+private:
+    std::string replayDir;
+    mutable AsyncFileWriter writer;   // 回放和文本文件在后台线程中写入
+    mutable bool saveFailed = false;  // 等待写入线程时发现的失败，由下一次saveSession返回
+
+    // 同一秒内保存的回放文件名追加序号（排队中的文件还不在磁盘上）
+    int64_t lastSavedAt = 0;
+    int lastSuffix = -1;
+
+    // 回放列表缓存（按保存顺序）和按文本哈希的索引
+    mutable std::vector<ReplayInfo> replayList;
+    mutable std::unordered_map<uint64_t, std::vector<size_t>> replayIndex;
+    mutable bool replayListLoaded = false;
+
+    // 文本存储路径
+    std::string getTextPath(uint64_t textHash) const;
+
+    // 读取回放文件，withText为false时不加载练习文本
+    bool readReplayFile(const std::string& path, ReplayData& data, uint32_t& eventCount, bool withText) const;
+
+    // 只读取回放文件头（版本1的文件没有记录用时，需要解码全部事件）
+    bool readReplayInfo(const std::string& path, ReplayInfo& info) const;
+
+    // 扫描回放目录建立缓存（第一次使用时）
+    void loadReplayList() const;
+
+    // 加入缓存
+    void addToReplayList(const ReplayInfo& info) const;
+
+    // 等待排队的回放写完，再读取回放目录
+    void waitForWriter() const;
+
+public:
+    ReplayManager();
+    ~ReplayManager();
+
+    // 设置回放目录（先写完排队的回放，再清空缓存）
+    void setReplayDir(const std::string& dir);
+
+    // 计算文本哈希（FNV-1a 64位）
+    static uint64_t hashText(const std::string& text);
+
+    // 保存一次完成的练习：编码后交给后台线程写入，返回false表示无法保存或之前排队的写入失败
+    bool saveSession(const TypingSession& session);
+
+    // 等待所有排队的回放写完（重命名或删除回放目录之前调用），返回是否全部成功
+    bool flush();
+
+    // 加载回放
+    bool loadReplay(const std::string& path, ReplayData& data) const;
+
+    // 列出所有回放（最新的在前）
+    std::vector<ReplayInfo> listReplays() const;
+
+    // 查找同一文本用时最短的完整回放（个人最佳），没有时返回false
+    bool findBestReplay(const std::string& text, ReplayData& data) const;
+
+    // 回放选择界面
+    void showReplayBrowser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin);
+
+    // 通过练习界面的渲染器播放回放
+    void playReplay(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin, const ReplayData& data);
+};
+
+#endif // SESSION_REPLAY_H
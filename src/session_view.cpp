@@ -0,0 +1,362 @@
+#include "session_view.h"
+#include "gui_helper.h"
+#include "utf8_text.h"
+#include <algorithm>
+
+using namespace std;
+using namespace GUIHelper;
+
+// 构造函数
+SessionView::SessionView(WINDOW* window, int topRow, int leftColumn, int rows)
+    : win(window), top(topRow), left(leftColumn), maxRows(rows)
+{
+}
+
+// 按宽度断行
+void SessionView::layout(const TypingSession& session, int lineWidth)
+{
+    width = max(lineWidth, 2);
+    lineBuffer.assign(static_cast<size_t>(width) + 1, L'\0');
+
+    visibleRows = viewportRows();
+    firstVisibleLine = 0;
+    ghostPosition = NO_GHOST;
+
+    lineStarts.clear();
+    relayoutFrom(session, 0);
+}
+
+// 视口占用文本区域到窗口下边框之间的所有行（不超过maxRows）
+size_t SessionView::viewportRows() const
+{
+    int rows = getmaxy(win) - top - 1;
+    if (maxRows > 0 && rows > maxRows)
+    {
+        rows = maxRows;
+    }
+    return static_cast<size_t>(max(rows, 1));
+}
+
+// 窗口大小改变后重新断行
+void SessionView::resize(const TypingSession& session, int lineWidth, int rows)
+{
+    maxRows = rows;
+    size_t ghost = ghostPosition;
+
+    if (max(lineWidth, 2) != width || lineStarts.empty())
+    {
+        layout(session, lineWidth);
+    }
+    else
+    {
+        visibleRows = viewportRows();
+    }
+
+    // 视口位置由下一次drawAll按光标重新计算
+    firstVisibleLine = 0;
+    ghostPosition = (ghost < textSize) ? ghost : NO_GHOST;
+}
+
+// 从第line行开始重新断行，尽量在空格处断开（空格留在下一行行首）
+void SessionView::relayoutFrom(const TypingSession& session, size_t line)
+{
+    const u32string& text = session.getText();
+    const vector<uint8_t>& widths = session.getWidths();
+
+    // 最后一行可能因追加的文本而需要重新断开，因此至少从最后一行开始
+    if (!lineStarts.empty() && line >= lineStarts.size())
+    {
+        line = lineStarts.size() - 1;
+    }
+
+    size_t start = 0;
+    if (line < lineStarts.size())
+    {
+        start = lineStarts[line];
+        lineStarts.resize(line);
+    }
+    textSize = text.size();
+    columns.resize(text.size());
+
+    while (start < text.size())
+    {
+        lineStarts.push_back(start);
+
+        // 计算本行能容纳的字符数
+        size_t fit = 0;
+        int used = 0;
+        while (start + fit < text.size() && used + widths[start + fit] <= width)
+        {
+            columns[start + fit] = static_cast<uint16_t>(used);
+            used += widths[start + fit];
+            fit++;
+        }
+
+        if (start + fit >= text.size())
+        {
+            break;
+        }
+
+        size_t breakPos = fit;
+        while (breakPos > 0 && text[start + breakPos] != U' ')
+        {
+            breakPos--;
+        }
+
+        // 没有空格可断开（如中文）时按宽度断开
+        if (breakPos == 0)
+        {
+            breakPos = fit;
+        }
+
+        start += breakPos;
+    }
+}
+
+// 丢弃视口上方的行
+size_t SessionView::discardLinesAboveViewport()
+{
+    if (firstVisibleLine == 0 || firstVisibleLine >= lineStarts.size())
+    {
+        return 0;
+    }
+
+    size_t removedChars = lineStarts[firstVisibleLine];
+    lineStarts.erase(lineStarts.begin(), lineStarts.begin() + firstVisibleLine);
+    for (auto& start : lineStarts)
+    {
+        start -= removedChars;
+    }
+    columns.erase(columns.begin(), columns.begin() + removedChars);
+    textSize -= removedChars;
+    if (ghostPosition != NO_GHOST)
+    {
+        ghostPosition = (ghostPosition >= removedChars) ? ghostPosition - removedChars : NO_GHOST;
+    }
+    firstVisibleLine = 0;
+
+    return removedChars;
+}
+
+// 将文本位置换算为所在行和行内偏移
+void SessionView::locate(size_t pos, int& line, int& column) const
+{
+    // 二分查找最后一个起点不大于pos的行
+    auto it = upper_bound(lineStarts.begin(), lineStarts.end(), pos);
+    size_t index = (it == lineStarts.begin()) ? 0 : (it - lineStarts.begin()) - 1;
+    line = static_cast<int>(index);
+    column = (pos < columns.size()) ? columns[pos] : 0;
+}
+
+// 第line行的结束位置
+size_t SessionView::lineEnd(size_t line) const
+{
+    return (line + 1 < lineStarts.size()) ? lineStarts[line + 1] : textSize;
+}
+
+// 调整视口使光标行可见：光标行保持在视口上方三分之一处，逐行滚动
+bool SessionView::scrollToCursor(const TypingSession& session)
+{
+    if (lineStarts.size() <= visibleRows)
+    {
+        return false;
+    }
+
+    int cursorLine, column;
+    locate(min(session.getPosition(), textSize - 1), cursorLine, column);
+
+    size_t lead = visibleRows / 3;
+    size_t maxFirst = lineStarts.size() - visibleRows;
+    size_t first = (static_cast<size_t>(cursorLine) > lead) ? cursorLine - lead : 0;
+    first = min(first, maxFirst);
+
+    if (first == firstVisibleLine)
+    {
+        return false;
+    }
+
+    firstVisibleLine = first;
+    return true;
+}
+
+// 绘制单个字符：已输入的显示输入内容（正确为绿色，错误为红色），
+// 当前位置高亮，幽灵光标所在位置用单独的颜色标出，其余显示原文
+void SessionView::drawChar(const TypingSession& session, size_t pos)
+{
+    const u32string& text = session.getText();
+    size_t position = session.getPosition();
+
+    char32_t ch;
+    int colorPair;
+    if (pos < position)
+    {
+        ch = session.getInput()[pos];
+        colorPair = session.isCorrectAt(pos) ? COLOR_CORRECT : COLOR_INCORRECT;
+
+        // 输错的字符比原文宽时会挤占后面的字符，改为显示原文
+        if (Utf8::displayWidth(ch) > session.getWidths()[pos])
+        {
+            ch = text[pos];
+        }
+    }
+    else if (pos == position)
+    {
+        // 遇错即停模式下按错时当前字符显示为错误颜色
+        ch = text[pos];
+        colorPair = session.isRejected() ? COLOR_INCORRECT : COLOR_CURRENT;
+    }
+    else
+    {
+        ch = text[pos];
+        colorPair = COLOR_DEFAULT;
+    }
+
+    if (pos == ghostPosition && pos != position)
+    {
+        colorPair = COLOR_GHOST;
+    }
+
+    int line, column;
+    locate(pos, line, column);
+    int row = top + line - static_cast<int>(firstVisibleLine);
+    wattron(win, COLOR_PAIR(colorPair));
+    putChar(row, left + column, ch);
+
+    // 输错的字符比原文窄时用空格补齐原文的宽度
+    for (int pad = Utf8::displayWidth(ch); pad < session.getWidths()[pos]; pad++)
+    {
+        waddch(win, ' ');
+    }
+    wattroff(win, COLOR_PAIR(colorPair));
+}
+
+// 输出一个字符
+void SessionView::putChar(int row, int column, char32_t ch)
+{
+    cchar_t cell;
+    wchar_t wide[2] = {Utf8::toDisplayChar(ch), L'\0'};
+    setcchar(&cell, wide, A_NORMAL, 0, nullptr);
+    mvwadd_wch(win, row, column, &cell);
+}
+
+// 绘制一整行
+void SessionView::drawLine(const TypingSession& session, size_t line)
+{
+    int row = top + static_cast<int>(line - firstVisibleLine);
+    wmove(win, row, left);
+
+    if (line >= lineStarts.size())
+    {
+        // 文本之后的空行
+        wprintw(win, "%*s", width, "");
+        return;
+    }
+
+    size_t start = lineStarts[line];
+    size_t end = lineEnd(line);
+    size_t position = session.getPosition();
+
+    // 已输入部分和当前字符逐个着色，尚未输入的部分一次性输出
+    size_t pos = start;
+    for (; pos < end && pos <= position; pos++)
+    {
+        drawChar(session, pos);
+    }
+
+    wattron(win, COLOR_PAIR(COLOR_DEFAULT));
+    if (pos < end)
+    {
+        const u32string& text = session.getText();
+        size_t count = 0;
+        for (size_t i = pos; i < end; i++)
+        {
+            lineBuffer[count++] = Utf8::toDisplayChar(text[i]);
+        }
+        mvwaddnwstr(win, row, left + columns[pos], lineBuffer.data(), static_cast<int>(count));
+    }
+    int used = (end > start) ? columns[end - 1] + session.getWidths()[end - 1] : 0;
+    if (used < width)
+    {
+        mvwprintw(win, row, left + used, "%*s", width - used, "");
+    }
+    wattroff(win, COLOR_PAIR(COLOR_DEFAULT));
+
+    // 幽灵光标在未输入部分时补画一次
+    if (ghostPosition >= pos && ghostPosition < end)
+    {
+        drawChar(session, ghostPosition);
+    }
+}
+
+// 绘制视口内的全部文本
+void SessionView::drawAll(const TypingSession& session)
+{
+    scrollToCursor(session);
+    for (size_t row = 0; row < visibleRows; row++)
+    {
+        drawLine(session, firstVisibleLine + row);
+    }
+}
+
+// 绘制位置区间内的字符（只写入窗口缓冲区，不刷新屏幕）
+void SessionView::drawRange(const TypingSession& session, size_t from, size_t to)
+{
+    if (lineStarts.empty())
+    {
+        return;
+    }
+
+    // 只绘制视口内的部分
+    size_t lastVisibleLine = min(firstVisibleLine + visibleRows, lineStarts.size()) - 1;
+    from = max(from, lineStarts[firstVisibleLine]);
+    to = min(to, lineEnd(lastVisibleLine));
+
+    for (size_t pos = from; pos < to; pos++)
+    {
+        drawChar(session, pos);
+    }
+}
+
+// 绘制需要重绘的部分
+void SessionView::drawDirty(TypingSession& session)
+{
+    if (scrollToCursor(session))
+    {
+        // 视口滚动后重绘所有可见行
+        drawAll(session);
+        session.clearDirty();
+        return;
+    }
+
+    if (session.hasDirty())
+    {
+        drawRange(session, session.getDirtyBegin(), session.getDirtyEnd());
+        session.clearDirty();
+    }
+}
+
+// 移动幽灵光标
+void SessionView::setGhostPosition(const TypingSession& session, size_t pos)
+{
+    if (pos == ghostPosition)
+    {
+        return;
+    }
+
+    size_t previous = ghostPosition;
+    ghostPosition = (pos < textSize) ? pos : NO_GHOST;
+    if (previous != NO_GHOST && previous < textSize)
+    {
+        drawRange(session, previous, previous + 1);
+    }
+    if (ghostPosition != NO_GHOST)
+    {
+        drawRange(session, ghostPosition, ghostPosition + 1);
+    }
+}
+
+// 刷新窗口
+void SessionView::refresh()
+{
+    wrefresh(win);
+}
@@ -0,0 +1,102 @@
+#ifndef SESSION_VIEW_H
+#define SESSION_VIEW_H
+
+#include <curses.h>
+#include <string>
+#include <vector>
+#include "typing_session.h"
+
+// 练习文本的显示
+// 负责将文本按窗口宽度断行，并根据TypingSession的状态绘制每个字符的颜色。
+// 断行按字符的显示宽度计算（中文等宽字符占两列），字符通过宽字符接口输出。
+// 只绘制视口内可见的行，光标所在行保持在视口上部，随输入逐行滚动，
+// 因此重绘开销只与可见行数有关，与文本长度无关
+class SessionView
+{
+public:
+    static const size_t NO_GHOST = static_cast<size_t>(-1);
+
+    // top/left 为文本区域在窗口中的起始行列，rows为视口的最大行数（0表示一直到窗口下边框）
+    SessionView(WINDOW* win, int top, int left, int rows = 0);
+
+    // 按每行最多width列对会话文本断行，视口高度取窗口剩余的行数（不超过rows）
+    void layout(const TypingSession& session, int width);
+
+    // 窗口大小改变后重新断行（rows同构造函数）：宽度不变时保留断行结果只调整视口高度。
+    // 输入和着色状态都保存在会话中，之后调用drawAll即可恢复，幽灵光标位置保留
+    void resize(const TypingSession& session, int width, int rows = 0);
+
+    // 保留前line行，从第line行开始重新断行（文本追加或后半部分被替换时使用）
+    void relayoutFrom(const TypingSession& session, size_t line);
+
+    // 丢弃视口上方的行，返回被丢弃的字符数（需同时调用TypingSession::discardPrefix）
+    size_t discardLinesAboveViewport();
+
+    // 绘制视口内的全部文本
+    void drawAll(const TypingSession& session);
+
+    // 绘制位置区间 [from, to) 内的字符（视口外的部分会被跳过）
+    void drawRange(const TypingSession& session, size_t from, size_t to);
+
+    // 绘制会话标记为需要重绘的部分并清除标记，光标离开视口时滚动
+    void drawDirty(TypingSession& session);
+
+    // 移动幽灵光标并重绘新旧两个位置，NO_GHOST表示不显示
+    void setGhostPosition(const TypingSession& session, size_t pos);
+
+    // 刷新窗口
+    void refresh();
+
+    // 行数
+    size_t getLineCount() const { return lineStarts.size(); }
+
+    // 视口第一行对应的文本行
+    size_t getFirstVisibleLine() const { return firstVisibleLine; }
+
+    // 视口下方第一行（尚未显示）对应的文本行，等于行数时表示没有未显示的行
+    size_t getFirstHiddenLine() const
+    {
+        return (firstVisibleLine + visibleRows < lineStarts.size()) ? firstVisibleLine + visibleRows : lineStarts.size();
+    }
+
+    // 第line行第一个字符的位置
+    size_t getLineStart(size_t line) const { return lineStarts[line]; }
+
+private:
+    // 按窗口高度计算视口行数
+    size_t viewportRows() const;
+
+    // 将文本位置换算为所在行和行内偏移
+    void locate(size_t pos, int& line, int& column) const;
+
+    // 第line行的结束位置（不含）
+    size_t lineEnd(size_t line) const;
+
+    // 调整视口使光标行可见，返回视口是否移动
+    bool scrollToCursor(const TypingSession& session);
+
+    // 绘制单个字符
+    void drawChar(const TypingSession& session, size_t pos);
+
+    // 绘制一整行（包括行尾空白）
+    void drawLine(const TypingSession& session, size_t line);
+
+    // 在指定位置输出一个字符
+    void putChar(int row, int column, char32_t ch);
+
+    WINDOW* win;
+    int top;
+    int left;
+    int maxRows;
+    int width = 1;
+    size_t textSize = 0;
+    std::vector<size_t> lineStarts;  // 每行第一个字符在文本中的位置
+    std::vector<uint16_t> columns;   // 每个字符在所在行中的起始列
+    std::vector<wchar_t> lineBuffer; // 输出一行未输入部分时使用的缓冲区
+
+    size_t firstVisibleLine = 0;     // 视口第一行对应的文本行
+    size_t visibleRows = 1;          // 视口高度
+    size_t ghostPosition = NO_GHOST; // 幽灵光标所在的文本位置
+};
+
+#endif // SESSION_VIEW_H
@@ -32,6 +32,12 @@ void SettingsManager::initDefaultSettings()
     // 添加 Ignore Case 设置，默认为禁用
     boolSettings[SettingKeys::IGNORE_CASE] = false;
     
+    // 添加 Adaptive Text 设置，默认为禁用
+    boolSettings[SettingKeys::ADAPTIVE_TEXT] = false;
+    
+    // 添加 Strict Mode 设置，默认为关闭
+    intSettings[SettingKeys::STRICT_MODE] = 0;
+    
     // 可以在这里添加更多默认设置
 }
 
@@ -247,7 +253,8 @@ void SettingsManager::showSettingsMenu(WINDOW* headerWin, WINDOW* contentWin, WI
 
     bool exitMenu = false;
     int selectedIndex = 0;
-    const int totalOptions = 2; // 现在有两个选项："Skip Space"和"Ignore Case"
+    const int totalOptions = 4; // "Skip Space"、"Ignore Case"、"Adaptive Text"和"Strict Mode"
+    const char* strictModeNames[] = {"Off", "Stop on error", "Must correct"};
     
     while (!exitMenu)
     {
@@ -262,6 +269,16 @@ void SettingsManager::showSettingsMenu(WINDOW* headerWin, WINDOW* contentWin, WI
         // "Ignore Case" 选项
         bool ignoreCase = getBoolSetting(SettingKeys::IGNORE_CASE, false);
         
+        // "Adaptive Text" 选项
+        bool adaptiveText = getBoolSetting(SettingKeys::ADAPTIVE_TEXT, false);
+        
+        // "Strict Mode" 选项（0~2）
+        int strictMode = getIntSetting(SettingKeys::STRICT_MODE, 0);
+        if (strictMode < 0 || strictMode > 2)
+        {
+            strictMode = 0;
+        }
+        
         // 绘制选择指示符和选项
         if (selectedIndex == 0)
         {
@@ -287,17 +304,49 @@ void SettingsManager::showSettingsMenu(WINDOW* headerWin, WINDOW* contentWin, WI
             wattroff(contentWin, A_REVERSE);
         }
         
+        if (selectedIndex == 2)
+        {
+            wattron(contentWin, A_REVERSE);
+        }
+        
+        mvwprintw(contentWin, 6, 2, "3. Adaptive Text: %s", adaptiveText ? "Enabled" : "Disabled");
+        
+        if (selectedIndex == 2)
+        {
+            wattroff(contentWin, A_REVERSE);
+        }
+        
+        if (selectedIndex == 3)
+        {
+            wattron(contentWin, A_REVERSE);
+        }
+        
+        mvwprintw(contentWin, 7, 2, "4. Strict Mode: %s", strictModeNames[strictMode]);
+        
+        if (selectedIndex == 3)
+        {
+            wattroff(contentWin, A_REVERSE);
+        }
+        
         // 添加帮助信息
         if (selectedIndex == 0) {
-            mvwprintw(contentWin, 7, 2, "Current setting: %s", skipSpace ? "Enabled" : "Disabled");
-            mvwprintw(contentWin, 8, 2, "When enabled, you don't need to type spaces.");
+            mvwprintw(contentWin, 9, 2, "Current setting: %s", skipSpace ? "Enabled" : "Disabled");
+            mvwprintw(contentWin, 10, 2, "When enabled, you don't need to type spaces.");
         } else if (selectedIndex == 1) {
-            mvwprintw(contentWin, 7, 2, "Current setting: %s", ignoreCase ? "Enabled" : "Disabled");
-            mvwprintw(contentWin, 8, 2, "When enabled, uppercase and lowercase are treated the same.");
+            mvwprintw(contentWin, 9, 2, "Current setting: %s", ignoreCase ? "Enabled" : "Disabled");
+            mvwprintw(contentWin, 10, 2, "When enabled, uppercase and lowercase are treated the same.");
+        } else if (selectedIndex == 2) {
+            mvwprintw(contentWin, 9, 2, "Current setting: %s", adaptiveText ? "Enabled" : "Disabled");
+            mvwprintw(contentWin, 10, 2, "When enabled, upcoming text is replaced with words that drill");
+            mvwprintw(contentWin, 11, 2, "the characters and key pairs you keep getting wrong.");
+        } else if (selectedIndex == 3) {
+            mvwprintw(contentWin, 9, 2, "Current setting: %s", strictModeNames[strictMode]);
+            mvwprintw(contentWin, 10, 2, "Stop on error: the cursor waits until the correct key is pressed.");
+            mvwprintw(contentWin, 11, 2, "Must correct: all errors must be fixed with backspace to finish.");
         }
         
         // 底部按键提示
-        mvwprintw(contentWin, getmaxy(contentWin) - 3, 2, "ENTER: Toggle setting  ESC: Return to menu");
+        mvwprintw(contentWin, getmaxy(contentWin) - 3, 2, "ENTER: Toggle/cycle setting  ESC: Return to menu");
         wattroff(contentWin, COLOR_PAIR(GUIHelper::COLOR_DEFAULT));
         
         GUIHelper::updateStatusWindowWithHelp(statusWin, "Use UP/DOWN to navigate", "ENTER to toggle, ESC to exit");
@@ -306,6 +355,11 @@ void SettingsManager::showSettingsMenu(WINDOW* headerWin, WINDOW* contentWin, WI
         int ch = wgetch(contentWin);
         switch (ch)
         {
+            case KEY_RESIZE:
+                // 终端大小改变，下一轮按新尺寸重绘
+                GUIHelper::resizeWindows(headerWin, contentWin, statusWin);
+                break;
+
             case KEY_UP:
                 selectedIndex = (selectedIndex - 1 + totalOptions) % totalOptions;
                 break;
@@ -338,6 +392,26 @@ void SettingsManager::showSettingsMenu(WINDOW* headerWin, WINDOW* contentWin, WI
                     GUIHelper::showMessageDialog(headerWin, contentWin, statusWin, message, 
                                                 GUIHelper::DIALOG_INFO, "Setting Changed");
                 }
+                else if (selectedIndex == 2) // Adaptive Text
+                {
+                    bool newValue = !adaptiveText;
+                    setBoolSetting(SettingKeys::ADAPTIVE_TEXT, newValue);
+                    
+                    // 显示确认消息
+                    string message = "Adaptive Text setting " + string(newValue ? "enabled" : "disabled");
+                    GUIHelper::showMessageDialog(headerWin, contentWin, statusWin, message, 
+                                                GUIHelper::DIALOG_INFO, "Setting Changed");
+                }
+                else if (selectedIndex == 3) // Strict Mode：在三种模式之间循环切换
+                {
+                    int newValue = (strictMode + 1) % 3;
+                    setIntSetting(SettingKeys::STRICT_MODE, newValue);
+                    
+                    // 显示确认消息
+                    string message = "Strict Mode set to " + string(strictModeNames[newValue]);
+                    GUIHelper::showMessageDialog(headerWin, contentWin, statusWin, message, 
+                                                GUIHelper::DIALOG_INFO, "Setting Changed");
+                }
                 break;
             
             case KEY_ESC:
@@ -60,6 +60,8 @@ public:
 namespace SettingKeys {
     const std::string SKIP_SPACE = "skip_space";  // 跳过空格设置
     const std::string IGNORE_CASE = "ignore_case"; // 忽略大小写设置
+    const std::string ADAPTIVE_TEXT = "adaptive_text"; // 练习中针对薄弱环节调整后续文本
+    const std::string STRICT_MODE = "strict_mode";     // 严格模式（整数：0关闭，1遇错即停，2必须改正）
 }
 
 #endif // SETTINGS_MANAGER_H
@@ -0,0 +1,70 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// 单生产者单消费者无锁队列
+// 固定容量的环形缓冲区，生产者只写tail，消费者只写head，
+// 通过acquire/release保证元素在另一端可见，不使用任何锁
+template <typename T>
+class SpscQueue
+{
+public:
+    // 容量向上取整为2的幂
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 生产者：放入元素，队列已满时返回false
+    bool push(T&& value)
+    {
+        size_t tailIndex = tail.load(std::memory_order_relaxed);
+        if (tailIndex - head.load(std::memory_order_acquire) == slots.size())
+        {
+            return false;
+        }
+        slots[tailIndex & mask] = std::move(value);
+        tail.store(tailIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：取出元素，队列为空时返回false
+    bool pop(T& value)
+    {
+        size_t headIndex = head.load(std::memory_order_relaxed);
+        if (headIndex == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = std::move(slots[headIndex & mask]);
+        head.store(headIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 队列是否已满（仅供生产者参考）
+    bool full() const
+    {
+        return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) == slots.size();
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+    std::atomic<size_t> head{0};  // 消费者读取位置
+    std::atomic<size_t> tail{0};  // 生产者写入位置
+};
+
+#endif // SPSC_QUEUE_H
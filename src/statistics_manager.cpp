@@ -1,11 +1,15 @@
 #include "statistics_manager.h"
 #include <fstream>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 
+namespace fs = std::filesystem;
 using namespace std;
 
 // 构造函数
-StatisticsManager::StatisticsManager() : statsLoaded(false)
+StatisticsManager::StatisticsManager() : statsLoaded(false), historyIndex(history)
 {
     // 初始化统计数据
     resetStatistics();
@@ -19,12 +23,17 @@ StatisticsManager::~StatisticsManager()
     {
         saveStatistics();
     }
+
+    // 退出前写完所有排队的数据
+    writer.stop();
 }
 
 // 设置统计文件路径
 void StatisticsManager::setStatsPath(const string& path)
 {
     statsPath = path;
+    history.setPath(path.empty() ? "" : SessionHistory::pathForStats(path));
+    historyIndex.clear();
 }
 
 // 重置统计数据
@@ -36,46 +45,645 @@ void StatisticsManager::resetStatistics()
     userStatistics.totalCorrectChars = 0;
     userStatistics.bestWPM = 0.0;
     userStatistics.bestAccuracy = 0.0;
-    userStatistics.errorChars.clear();
+    userStatistics.keyStats.clear();
+    userStatistics.errorWords.clear();
+    userStatistics.errorBigrams.clear();
     statsLoaded = false;
 }
 
+namespace {
+
+// 统计文件格式（版本2）：
+//   "TPST" | 版本(u16) | 保留(u16) | 负载长度(u32) | 负载CRC-32(u32) | 负载
+// 负载由若干段组成，每段为 标签(u16) | 长度(u32) | 内容。所有整数为小端，浮点数按IEEE 754双精度的位模式保存。
+// 读取时跳过不认识的段，新增字段只需新增段或在段尾追加，旧文件和旧程序都不受影响；
+// 不兼容的改动才需要提高版本号。
+// 版本1是没有文件头的旧格式：按本机字节序直接写入的int/double/size_t/char
+const char STATS_MAGIC[4] = {'T', 'P', 'S', 'T'};
+const uint16_t STATS_VERSION = 2;
+const size_t STATS_HEADER_SIZE = 16;
+const size_t MAX_STATS_FILE_SIZE = 64 * 1024 * 1024;  // 超过此大小的文件视为损坏
+
+enum StatsSection : uint16_t
+{
+    SECTION_TOTALS = 1,         // 次数、用时、字符数和最佳成绩
+    SECTION_ERROR_CHARS = 2,    // 常错字符（只读取，已被SECTION_KEY_STATS取代）
+    SECTION_ERROR_WORDS = 3,    // 常错单词
+    SECTION_ERROR_BIGRAMS = 4,  // 常错双字母组合字符串表（只读取，已被SECTION_BIGRAM_MATRIX取代）
+    SECTION_KEY_STATS = 5,      // 每个键的统计：数量，然后每项为 键(u8) | 次数 | 错误 | 延迟样本数 | 均值(f64) | M2(f64)
+    SECTION_BIGRAM_MATRIX = 6   // 双字母组合矩阵的非零项：数量，然后每项为 第一个字符(u8) | 第二个字符(u8) | 错误(u32)
+};
+
+const size_t KEY_ENTRY_SIZE = 1 + 4 + 4 + 4 + 8 + 8;
+const size_t BIGRAM_ENTRY_SIZE = 1 + 1 + 4;
+
+const size_t TOTALS_SIZE = 4 + 8 + 4 + 4 + 8 + 8;
+
+// CRC-32（IEEE 802.3多项式）查找表
+struct Crc32Table
+{
+    uint32_t entries[256];
+
+    Crc32Table()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+uint32_t crc32(const char* data, size_t length)
+{
+    static const Crc32Table table;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc = table.entries[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// 小端写入
+void putU8(string& out, uint8_t value)
+{
+    out += static_cast<char>(value);
+}
+
+void putU16(string& out, uint16_t value)
+{
+    out += static_cast<char>(value & 0xFF);
+    out += static_cast<char>(value >> 8);
+}
+
+void putU32(string& out, uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+void putU64(string& out, uint64_t value)
+{
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+void putF64(string& out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    putU64(out, bits);
+}
+
+// 改写已写入的u32（先写占位的数量，写完各项后填入）
+void overwriteU32(string& out, size_t offset, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[offset + i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+// 计数不会为负，写入时把负数当作0
+uint32_t toCount(int value)
+{
+    return value > 0 ? static_cast<uint32_t>(value) : 0;
+}
+
+// 追加一段：标签、长度和内容
+void putSection(string& out, StatsSection tag, const string& content)
+{
+    putU16(out, tag);
+    putU32(out, static_cast<uint32_t>(content.size()));
+    out += content;
+}
+
+// 字符串计数表：数量，然后每项为 长度(u8) | 字符串 | 计数(u32)
+string encodeStringCounts(const map<string, int>& counts)
+{
+    string out;
+    putU32(out, static_cast<uint32_t>(counts.size()));
+    for (const auto& pair : counts)
+    {
+        size_t length = min<size_t>(pair.first.size(), 255);
+        putU8(out, static_cast<uint8_t>(length));
+        out.append(pair.first, 0, length);
+        putU32(out, toCount(pair.second));
+    }
+    return out;
+}
+
+// 带边界检查的小端读取，越界后ok变为false，之后的读取都返回0
+class ByteReader
+{
+public:
+    ByteReader(const char* data, size_t size) : data(data), size(size) {}
+
+    bool isOk() const { return ok; }
+    bool atEnd() const { return pos == size; }
+    size_t remaining() const { return size - pos; }
+
+    const char* take(size_t count)
+    {
+        if (!ok || count > size - pos)
+        {
+            ok = false;
+            return nullptr;
+        }
+        const char* result = data + pos;
+        pos += count;
+        return result;
+    }
+
+    uint8_t u8()
+    {
+        const char* bytes = take(1);
+        return bytes != nullptr ? static_cast<uint8_t>(bytes[0]) : 0;
+    }
+
+    uint16_t u16()
+    {
+        const char* bytes = take(2);
+        return bytes != nullptr ? static_cast<uint16_t>(static_cast<uint8_t>(bytes[0]) | (static_cast<uint8_t>(bytes[1]) << 8)) : 0;
+    }
+
+    uint32_t u32()
+    {
+        const char* bytes = take(4);
+        uint32_t value = 0;
+        for (int i = 3; bytes != nullptr && i >= 0; i--)
+        {
+            value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+        }
+        return value;
+    }
+
+    uint64_t u64()
+    {
+        const char* bytes = take(8);
+        uint64_t value = 0;
+        for (int i = 7; bytes != nullptr && i >= 0; i--)
+        {
+            value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+        }
+        return value;
+    }
+
+    double f64()
+    {
+        uint64_t bits = u64();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+};
+
+// 计数必须能放进int
+bool readCount(ByteReader& reader, int& value)
+{
+    uint32_t count = reader.u32();
+    value = static_cast<int>(count);
+    return reader.isOk() && count <= static_cast<uint32_t>(INT32_MAX);
+}
+
+// 读取字符串计数表，内容必须恰好用完
+bool decodeStringCounts(ByteReader& reader, map<string, int>& counts)
+{
+    uint32_t entries = reader.u32();
+    // 每项至少5字节，数量不可能超过剩余长度
+    if (!reader.isOk() || entries > reader.remaining() / 5)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < entries; i++)
+    {
+        uint8_t length = reader.u8();
+        const char* key = reader.take(length);
+        int value = 0;
+        if (key == nullptr || !readCount(reader, value))
+        {
+            return false;
+        }
+        counts[string(key, length)] = value;
+    }
+    return reader.atEnd();
+}
+
+// 把旧格式的双字母组合字符串表转换为矩阵
+void addBigramCounts(const map<string, int>& bigrams, BigramMatrix& matrix)
+{
+    for (const auto& pair : bigrams)
+    {
+        if (pair.first.size() == 2)
+        {
+            matrix.add(static_cast<unsigned char>(pair.first[0]), static_cast<unsigned char>(pair.first[1]), toCount(pair.second));
+        }
+    }
+}
+
+// 解析版本2的负载，失败时返回错误原因
+string decodeStats(const char* payload, size_t length, UserStats& stats)
+{
+    bool hasTotals = false;
+    ByteReader reader(payload, length);
+    while (!reader.atEnd())
+    {
+        uint16_t tag = reader.u16();
+        uint32_t sectionLength = reader.u32();
+        const char* section = reader.take(sectionLength);
+        if (section == nullptr)
+        {
+            return "section extends past the end of the file";
+        }
+
+        ByteReader content(section, sectionLength);
+        switch (tag)
+        {
+        case SECTION_TOTALS:
+            // 以后在段尾追加的字段由新版本读取，这里忽略
+            if (sectionLength < TOTALS_SIZE)
+            {
+                return "totals section is too short";
+            }
+            readCount(content, stats.sessionsCompleted);
+            stats.totalTypingTime = content.f64();
+            readCount(content, stats.totalCharsTyped);
+            readCount(content, stats.totalCorrectChars);
+            stats.bestWPM = content.f64();
+            stats.bestAccuracy = content.f64();
+            if (stats.sessionsCompleted < 0 || stats.totalCharsTyped < 0 || stats.totalCorrectChars < 0 ||
+                !(stats.totalTypingTime >= 0.0) || !(stats.bestWPM >= 0.0) || !(stats.bestAccuracy >= 0.0))
+            {
+                return "totals section has invalid values";
+            }
+            hasTotals = true;
+            break;
+
+        case SECTION_ERROR_CHARS:
+        {
+            uint32_t entries = content.u32();
+            if (!content.isOk() || content.remaining() != static_cast<uint64_t>(entries) * 5)
+            {
+                return "error character section has the wrong size";
+            }
+            for (uint32_t i = 0; i < entries; i++)
+            {
+                uint8_t key = content.u8();
+                int count = 0;
+                if (!readCount(content, count))
+                {
+                    return "error character section has invalid counts";
+                }
+
+                // 旧版本也记录了UTF-8字节（如拼音文本中的0xC3），按键表中没有对应的键，直接跳过
+                if (key < KeyStatsTable::KEY_COUNT)
+                {
+                    stats.keyStats.addErrors(key, static_cast<uint32_t>(count));
+                }
+            }
+            break;
+        }
+
+        case SECTION_ERROR_WORDS:
+            if (!decodeStringCounts(content, stats.errorWords))
+            {
+                return "error word section is malformed";
+            }
+            break;
+
+        case SECTION_ERROR_BIGRAMS:
+        {
+            map<string, int> bigrams;
+            if (!decodeStringCounts(content, bigrams))
+            {
+                return "error bigram section is malformed";
+            }
+            addBigramCounts(bigrams, stats.errorBigrams);
+            break;
+        }
+
+        case SECTION_KEY_STATS:
+        {
+            uint32_t entries = content.u32();
+            if (!content.isOk() || content.remaining() != static_cast<uint64_t>(entries) * KEY_ENTRY_SIZE)
+            {
+                return "key statistics section has the wrong size";
+            }
+            for (uint32_t i = 0; i < entries; i++)
+            {
+                uint8_t key = content.u8();
+                uint32_t count = content.u32();
+                uint32_t errors = content.u32();
+                uint32_t samples = content.u32();
+                double mean = content.f64();
+                double m2 = content.f64();
+                if (key >= KeyStatsTable::KEY_COUNT || errors > count || samples > count || !(mean >= 0.0) || !(m2 >= 0.0))
+                {
+                    return "key statistics section has invalid values";
+                }
+                stats.keyStats.set(key, count, errors, samples, mean, m2);
+            }
+            break;
+        }
+
+        case SECTION_BIGRAM_MATRIX:
+        {
+            uint32_t entries = content.u32();
+            if (!content.isOk() || content.remaining() != static_cast<uint64_t>(entries) * BIGRAM_ENTRY_SIZE)
+            {
+                return "bigram section has the wrong size";
+            }
+            for (uint32_t i = 0; i < entries; i++)
+            {
+                uint8_t first = content.u8();
+                uint8_t second = content.u8();
+                uint32_t errors = content.u32();
+                if (!BigramMatrix::contains(first, second))
+                {
+                    return "bigram section has invalid characters";
+                }
+                stats.errorBigrams.add(first, second, errors);
+            }
+            break;
+        }
+
+        default:
+            // 新版本增加的段
+            break;
+        }
+    }
+
+    return hasTotals ? "" : "totals section is missing";
+}
+
+// 从流中读取本机格式的值（旧格式）
+template <typename T>
+bool readRaw(ifstream& file, T& value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+// 旧格式的字符串计数表：数量(size_t)，然后每项为长度(u8)、字符串和计数(int)
+// 文件在表开始处结束表示写入它的程序版本还没有这张表；表中途结束说明文件被截断
+bool readLegacyStringCounts(ifstream& file, uintmax_t fileSize, map<string, int>& counts)
+{
+    if (file.peek() == ifstream::traits_type::eof())
+    {
+        file.clear();
+        return true;
+    }
+
+    size_t entries = 0;
+    if (!readRaw(file, entries) || entries > fileSize / (1 + sizeof(int)))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < entries; ++i)
+    {
+        uint8_t length = 0;
+        int value = 0;
+        if (!readRaw(file, length))
+        {
+            return false;
+        }
+        string key(length, '\0');
+        if (!file.read(&key[0], length) || !readRaw(file, value) || value < 0)
+        {
+            return false;
+        }
+        counts[key] = value;
+    }
+    return true;
+}
+
+// 逐项读取旧格式，失败时返回错误原因
+string readLegacyStats(ifstream& file, uintmax_t fileSize, UserStats& stats)
+{
+    if (!readRaw(file, stats.sessionsCompleted) || !readRaw(file, stats.totalTypingTime) ||
+        !readRaw(file, stats.totalCharsTyped) || !readRaw(file, stats.totalCorrectChars) ||
+        !readRaw(file, stats.bestWPM) || !readRaw(file, stats.bestAccuracy))
+    {
+        return "legacy statistics file is truncated";
+    }
+    if (stats.sessionsCompleted < 0 || stats.totalCharsTyped < 0 || stats.totalCorrectChars < 0 ||
+        !(stats.totalTypingTime >= 0.0) || !(stats.bestWPM >= 0.0) || !(stats.bestAccuracy >= 0.0))
+    {
+        return "legacy statistics file has invalid values";
+    }
+
+    size_t entries = 0;
+    if (!readRaw(file, entries) || entries > fileSize / (1 + sizeof(int)))
+    {
+        return "legacy error character table is malformed";
+    }
+    for (size_t i = 0; i < entries; ++i)
+    {
+        char key = 0;
+        int value = 0;
+        if (!readRaw(file, key) || !readRaw(file, value) || value < 0)
+        {
+            return "legacy error character table is truncated";
+        }
+
+        // 非ASCII字节没有对应的键，跳过
+        if (static_cast<unsigned char>(key) < KeyStatsTable::KEY_COUNT)
+        {
+            stats.keyStats.addErrors(static_cast<unsigned char>(key), static_cast<uint32_t>(value));
+        }
+    }
+
+    map<string, int> bigrams;
+    if (!readLegacyStringCounts(file, fileSize, stats.errorWords) ||
+        !readLegacyStringCounts(file, fileSize, bigrams))
+    {
+        return "legacy error word tables are truncated";
+    }
+    addBigramCounts(bigrams, stats.errorBigrams);
+    if (file.peek() != ifstream::traits_type::eof())
+    {
+        return "legacy statistics file has trailing data";
+    }
+    return "";
+}
+
+} // namespace
+
 // 加载统计数据
+// 新格式先校验文件头、长度和CRC，再解析到临时对象，任何一步失败都不改变当前统计；
+// 旧格式逐项读取并校验，成功后立即以新格式保存。无法读取的文件改名为.corrupt保留，
+// 以免之后的保存把它覆盖
 bool StatisticsManager::loadStatistics()
 {
+    loadError.clear();
     if (statsPath.empty())
     {
         return false;
     }
 
-    ifstream file(statsPath, ios::binary);
-    if (file)
+    // 同一文件可能还有尚未写出的保存（例如切换用户后又切换回来）
+    waitForWriter();
+
+    ifstream file(statsPath, ios::binary | ios::ate);
+    if (!file)
     {
-        file.read(reinterpret_cast<char*>(&userStatistics.sessionsCompleted), sizeof(userStatistics.sessionsCompleted));
-        file.read(reinterpret_cast<char*>(&userStatistics.totalTypingTime), sizeof(userStatistics.totalTypingTime));
-        file.read(reinterpret_cast<char*>(&userStatistics.totalCharsTyped), sizeof(userStatistics.totalCharsTyped));
-        file.read(reinterpret_cast<char*>(&userStatistics.totalCorrectChars), sizeof(userStatistics.totalCorrectChars));
-        file.read(reinterpret_cast<char*>(&userStatistics.bestWPM), sizeof(userStatistics.bestWPM));
-        file.read(reinterpret_cast<char*>(&userStatistics.bestAccuracy), sizeof(userStatistics.bestAccuracy));
+        return false;
+    }
 
-        // 加载错误字符统计
-        size_t mapSize;
-        file.read(reinterpret_cast<char*>(&mapSize), sizeof(mapSize));
+    uintmax_t fileSize = static_cast<uintmax_t>(file.tellg());
+    file.seekg(0);
 
-        for (size_t i = 0; i < mapSize; ++i)
+    UserStats loaded;
+    bool legacy = false;
+    char magic[4] = {};
+    if (fileSize > MAX_STATS_FILE_SIZE)
+    {
+        loadError = "statistics file is too large";
+    }
+    else if (fileSize >= sizeof(magic) && file.read(magic, sizeof(magic)) &&
+             memcmp(magic, STATS_MAGIC, sizeof(magic)) == 0)
+    {
+        string content(static_cast<size_t>(fileSize), '\0');
+        file.seekg(0);
+        if (!file.read(&content[0], static_cast<streamsize>(fileSize)) || fileSize < STATS_HEADER_SIZE)
         {
-            char key;
-            int value;
-            file.read(reinterpret_cast<char*>(&key), sizeof(key));
-            file.read(reinterpret_cast<char*>(&value), sizeof(value));
-            userStatistics.errorChars[key] = value;
+            loadError = "statistics file header is truncated";
         }
+        else
+        {
+            ByteReader header(content.data(), STATS_HEADER_SIZE);
+            header.take(sizeof(STATS_MAGIC));
+            uint16_t version = header.u16();
+            header.u16();
+            uint32_t payloadLength = header.u32();
+            uint32_t payloadCrc = header.u32();
 
-        statsLoaded = true;
-        return true;
+            const char* payload = content.data() + STATS_HEADER_SIZE;
+            if (version != STATS_VERSION)
+            {
+                loadError = "unsupported statistics file version " + to_string(version);
+            }
+            else if (payloadLength != fileSize - STATS_HEADER_SIZE)
+            {
+                loadError = "statistics file is truncated";
+            }
+            else if (crc32(payload, payloadLength) != payloadCrc)
+            {
+                loadError = "statistics file checksum mismatch";
+            }
+            else
+            {
+                loadError = decodeStats(payload, payloadLength, loaded);
+            }
+        }
+    }
+    else
+    {
+        file.clear();
+        file.seekg(0);
+        legacy = true;
+        loadError = readLegacyStats(file, fileSize, loaded);
+    }
+    file.close();
+
+    if (!loadError.empty())
+    {
+        error_code ec;
+        fs::remove(statsPath + ".corrupt", ec);
+        fs::rename(statsPath, statsPath + ".corrupt", ec);
+        return false;
+    }
+
+    userStatistics = loaded;
+    statsLoaded = true;
+    if (legacy)
+    {
+        saveStatistics();
+    }
+    return true;
+}
+
+// 将统计数据编码为版本2格式
+string StatisticsManager::encodeStatistics() const
+{
+    string payload;
+
+    string totals;
+    putU32(totals, toCount(userStatistics.sessionsCompleted));
+    putF64(totals, userStatistics.totalTypingTime);
+    putU32(totals, toCount(userStatistics.totalCharsTyped));
+    putU32(totals, toCount(userStatistics.totalCorrectChars));
+    putF64(totals, userStatistics.bestWPM);
+    putF64(totals, userStatistics.bestAccuracy);
+    putSection(payload, SECTION_TOTALS, totals);
+
+    putSection(payload, SECTION_ERROR_WORDS, encodeStringCounts(userStatistics.errorWords));
+
+    // 两张定长表只保存有数据的项
+    const KeyStatsTable& keys = userStatistics.keyStats;
+    string keyStats;
+    uint32_t keyEntries = 0;
+    putU32(keyStats, 0);
+    for (size_t key = 0; key < KeyStatsTable::KEY_COUNT; key++)
+    {
+        unsigned char ch = static_cast<unsigned char>(key);
+        if (keys.getCount(ch) == 0 && keys.getErrors(ch) == 0)
+        {
+            continue;
+        }
+        putU8(keyStats, ch);
+        putU32(keyStats, keys.getCount(ch));
+        putU32(keyStats, keys.getErrors(ch));
+        putU32(keyStats, keys.getLatencySamples(ch));
+        putF64(keyStats, keys.getMeanLatency(ch));
+        putF64(keyStats, keys.getLatencyM2(ch));
+        keyEntries++;
     }
-    
-    return false;
+    overwriteU32(keyStats, 0, keyEntries);
+    putSection(payload, SECTION_KEY_STATS, keyStats);
+
+    string bigrams;
+    uint32_t bigramEntries = 0;
+    putU32(bigrams, 0);
+    for (uint32_t cell = 0; cell < BigramMatrix::CELL_COUNT; cell++)
+    {
+        uint32_t errors = userStatistics.errorBigrams.getCell(cell);
+        if (errors == 0)
+        {
+            continue;
+        }
+        putU8(bigrams, BigramMatrix::firstOf(cell));
+        putU8(bigrams, BigramMatrix::secondOf(cell));
+        putU32(bigrams, errors);
+        bigramEntries++;
+    }
+    overwriteU32(bigrams, 0, bigramEntries);
+    putSection(payload, SECTION_BIGRAM_MATRIX, bigrams);
+
+    string out;
+    out.append(STATS_MAGIC, sizeof(STATS_MAGIC));
+    putU16(out, STATS_VERSION);
+    putU16(out, 0);
+    putU32(out, static_cast<uint32_t>(payload.size()));
+    putU32(out, crc32(payload.data(), payload.size()));
+    out += payload;
+    return out;
 }
 
 // 保存统计数据
@@ -86,30 +694,42 @@ bool StatisticsManager::saveStatistics()
         return false;
     }
 
-    ofstream file(statsPath, ios::binary);
-    if (file)
+    writer.replace(statsPath, encodeStatistics());
+
+    // 写入在后台进行，这里报告之前排队的写入是否失败
+    string error;
+    if (writer.takeError(error))
     {
-        file.write(reinterpret_cast<char*>(&userStatistics.sessionsCompleted), sizeof(userStatistics.sessionsCompleted));
-        file.write(reinterpret_cast<char*>(&userStatistics.totalTypingTime), sizeof(userStatistics.totalTypingTime));
-        file.write(reinterpret_cast<char*>(&userStatistics.totalCharsTyped), sizeof(userStatistics.totalCharsTyped));
-        file.write(reinterpret_cast<char*>(&userStatistics.totalCorrectChars), sizeof(userStatistics.totalCorrectChars));
-        file.write(reinterpret_cast<char*>(&userStatistics.bestWPM), sizeof(userStatistics.bestWPM));
-        file.write(reinterpret_cast<char*>(&userStatistics.bestAccuracy), sizeof(userStatistics.bestAccuracy));
+        saveError = error;
+        saveFailed = true;
+    }
+    return takeSaveFailure();
+}
 
-        // 保存错误字符统计
-        size_t mapSize = userStatistics.errorChars.size();
-        file.write(reinterpret_cast<char*>(&mapSize), sizeof(mapSize));
+// 等待所有数据落盘
+bool StatisticsManager::flush()
+{
+    waitForWriter();
+    return takeSaveFailure();
+}
 
-        for (const auto& pair : userStatistics.errorChars)
-        {
-            file.write(reinterpret_cast<const char*>(&pair.first), sizeof(pair.first));
-            file.write(reinterpret_cast<const char*>(&pair.second), sizeof(pair.second));
-        }
-        
-        return true;
+// 等待后台写入完成，期间的失败留给saveStatistics或flush报告
+void StatisticsManager::waitForWriter()
+{
+    string error;
+    if (!writer.flush(&error))
+    {
+        saveError = error;
+        saveFailed = true;
     }
-    
-    return false;
+}
+
+// 取出尚未报告的写入失败，返回是否全部成功
+bool StatisticsManager::takeSaveFailure()
+{
+    bool succeeded = !saveFailed;
+    saveFailed = false;
+    return succeeded;
 }
 
 // 更新统计数据
@@ -137,14 +757,56 @@ void StatisticsManager::updateStatistics(double timeTaken, int charsTyped, int c
     saveStatistics();
 }
 
-// 更新错误字符
-void StatisticsManager::updateErrorChar(char errorChar)
+// 在历史文件中追加一次练习的记录（已映射的历史在下次open时才包含这条记录）
+// 路径在提交时确定，之后切换用户不影响这条记录写入的文件
+void StatisticsManager::recordSession(const SessionRecord& record)
+{
+    string historyPath = history.getPath();
+    if (!historyPath.empty())
+    {
+        writer.post(historyPath, [historyPath, record]()
+        {
+            return SessionHistory::append(historyPath, record);
+        });
+    }
+}
+
+// 练习历史
+SessionHistory& StatisticsManager::getHistory()
+{
+    waitForWriter();
+    return history;
+}
+
+// 练习历史的查询索引
+const HistoryIndex& StatisticsManager::getHistoryIndex()
+{
+    waitForWriter();
+    history.open();
+    historyIndex.refresh();
+    return historyIndex;
+}
+
+// 累计一次练习的逐键统计
+void StatisticsManager::mergeKeyStats(const KeyStatsTable& sessionKeys)
+{
+    userStatistics.keyStats.merge(sessionKeys);
+}
+
+// 更新常错单词
+void StatisticsManager::updateErrorWord(const string& word, int count)
+{
+    userStatistics.errorWords[word] += count;
+}
+
+// 更新常错双字母组合
+void StatisticsManager::updateErrorBigram(char first, char second, int count)
 {
-    userStatistics.errorChars[errorChar]++;
+    userStatistics.errorBigrams.add(static_cast<unsigned char>(first), static_cast<unsigned char>(second), toCount(count));
 }
 
 // 获取统计信息
-UserStats StatisticsManager::getStatistics() const
+const UserStats& StatisticsManager::getStatistics() const
 {
     return userStatistics;
 }
@@ -3,6 +3,10 @@
 
 #include <string>
 #include <map>
+#include "key_stats.h"
+#include "session_history.h"
+#include "history_index.h"
+#include "async_file_writer.h"
 
 // 用户统计信息结构
 struct UserStats
@@ -13,7 +17,9 @@ struct UserStats
     int totalCorrectChars = 0;
     double bestWPM = 0.0;
     double bestAccuracy = 0.0;
-    std::map<char, int> errorChars; // 用于跟踪常见错误字符
+    KeyStatsTable keyStats;                  // 每个ASCII键的输入次数、错误次数和延迟
+    std::map<std::string, int> errorWords;   // 常错单词
+    BigramMatrix errorBigrams;               // 常错双字母组合（可打印ASCII字符）
 };
 
 class StatisticsManager
@@ -22,35 +28,74 @@ private:
     UserStats userStatistics;
     bool statsLoaded = false;
     std::string statsPath;
+    SessionHistory history;
+    HistoryIndex historyIndex;  // 练习历史的查询索引，在history之后构造
+    std::string loadError;
+    std::string saveError;
+    bool saveFailed = false;  // 有尚未报告的写入失败
+    AsyncFileWriter writer;  // 统计和历史文件都在后台线程中写入
+
+    // 等待后台写入完成，记下期间的写入失败
+    void waitForWriter();
+
+    // 取出尚未报告的写入失败，返回是否全部成功
+    bool takeSaveFailure();
+
+    // 将统计数据编码为文件内容
+    std::string encodeStatistics() const;
 
 public:
     StatisticsManager();
     ~StatisticsManager();
 
-    // 设置统计文件路径
+    // 设置统计文件路径（同时设置同名的历史文件路径）
     void setStatsPath(const std::string& path);
+    const std::string& getStatsPath() const { return statsPath; }
     
-    // 加载统计数据
+    // 加载统计数据（旧格式的文件会被转换为新格式）
     bool loadStatistics();
     
-    // 保存统计数据
+    // 保存统计数据：编码后交给后台线程写入临时文件、fsync并重命名，不等待磁盘
+    // 返回false表示路径为空，或之前排队的写入失败（原因见getSaveError）
     bool saveStatistics();
+
+    // 等待所有尚未写出的统计和历史数据落盘，有写入失败时返回false
+    bool flush();
     
     // 更新统计数据
     void updateStatistics(double timeTaken, int charsTyped, int correctChars, double wpm, double accuracy);
     
-    // 更新错误字符
-    void updateErrorChar(char errorChar);
+    // 在历史文件中追加一次练习的记录（在后台线程中写入）
+    void recordSession(const SessionRecord& record);
+
+    // 练习历史（读取前调用open映射文件）；先等待尚未写出的记录，保证映射包含它们
+    SessionHistory& getHistory();
+
+    // 练习历史的查询索引：重新映射历史文件并把新记录加入索引，历史文件不存在时索引为空
+    const HistoryIndex& getHistoryIndex();
+    
+    // 累计一次练习的逐键统计
+    void mergeKeyStats(const KeyStatsTable& sessionKeys);
+
+    // 更新常错单词和双字母组合
+    void updateErrorWord(const std::string& word, int count);
+    void updateErrorBigram(char first, char second, int count);
     
     // 重置统计数据
     void resetStatistics();
     
     // 获取统计信息
-    UserStats getStatistics() const;
+    const UserStats& getStatistics() const;
     
     // 设置统计信息
     void setStatistics(const UserStats& stats);
     
+    // 上次加载失败的原因（文件不存在不算失败），为空表示没有错误
+    const std::string& getLoadError() const { return loadError; }
+
+    // 最近一次后台写入失败的原因
+    const std::string& getSaveError() const { return saveError; }
+    
     // 检查是否已加载统计
     bool isStatsLoaded() const { return statsLoaded; }
 };
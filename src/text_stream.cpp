@@ -0,0 +1,79 @@
+#include "text_stream.h"
+#include <chrono>
+
+using namespace std;
+using namespace std::chrono;
+
+// 构造函数
+TextStreamProducer::TextStreamProducer(Generator textGenerator, size_t queueCapacity)
+    : generator(textGenerator), queue(queueCapacity)
+{
+}
+
+// 析构函数
+TextStreamProducer::~TextStreamProducer()
+{
+    stop();
+}
+
+// 启动后台线程
+void TextStreamProducer::start()
+{
+    if (worker.joinable())
+    {
+        return;
+    }
+    stopping = false;
+    worker = thread(&TextStreamProducer::run, this);
+}
+
+// 停止后台线程
+void TextStreamProducer::stop()
+{
+    stopping = true;
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+}
+
+// 取出一段文本
+bool TextStreamProducer::tryPop(string& chunk)
+{
+    return queue.pop(chunk);
+}
+
+// 等待第一段文本
+bool TextStreamProducer::waitPop(string& chunk, int timeoutMs)
+{
+    auto deadline = steady_clock::now() + milliseconds(timeoutMs);
+    while (!queue.pop(chunk))
+    {
+        if (steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        this_thread::sleep_for(milliseconds(5));
+    }
+    return true;
+}
+
+// 后台线程主循环：保持队列填满，队列已满时休眠等待消费
+void TextStreamProducer::run()
+{
+    string pending;
+    while (!stopping)
+    {
+        if (pending.empty())
+        {
+            pending = generator();
+        }
+
+        if (pending.empty() || !queue.push(move(pending)))
+        {
+            this_thread::sleep_for(milliseconds(20));
+            continue;
+        }
+        pending.clear();
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef TEXT_STREAM_H
+#define TEXT_STREAM_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include "spsc_queue.h"
+
+// 无尽模式的文本来源
+// 后台线程反复调用文本生成器，将生成的文本段放入无锁队列，
+// 练习界面在剩余文本不足时从队列中取出并追加，读取语料文件不会阻塞输入
+class TextStreamProducer
+{
+public:
+    typedef std::function<std::string()> Generator;
+
+    // queueCapacity 为预先生成的文本段数量上限
+    explicit TextStreamProducer(Generator generator, size_t queueCapacity = 8);
+    ~TextStreamProducer();
+
+    // 启动和停止后台线程
+    void start();
+    void stop();
+
+    // 取出一段文本（不阻塞），队列为空时返回false
+    bool tryPop(std::string& chunk);
+
+    // 等待第一段文本，最多等待timeoutMs毫秒
+    bool waitPop(std::string& chunk, int timeoutMs);
+
+private:
+    // 后台线程主循环
+    void run();
+
+    Generator generator;
+    SpscQueue<std::string> queue;
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+};
+
+#endif // TEXT_STREAM_H
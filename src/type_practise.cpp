@@ -10,6 +10,7 @@ UserManager *userManager = nullptr;
 StatisticsManager *statsManager = nullptr;
 CorpusManager *corpusManager = nullptr;
 SettingsManager *settingsManager = nullptr; // 添加设置管理器实例
+ReplayManager *replayManager = nullptr;     // 练习回放管理器实例
 
 // 窗口对象
 WINDOW *headerWin = nullptr;
@@ -46,6 +47,12 @@ void clearContentWindow()
     GUIHelper::clearContentWindow(contentWin);
 }
 
+// 终端大小改变后调整窗口，替换为调用GUIHelper版本
+void resizeWindows()
+{
+    GUIHelper::resizeWindows(headerWin, contentWin, statusWin);
+}
+
 // 随机生成练习文本，修改为从语料库中获取
 string generatePracticeText(int wordCount)
 {
@@ -85,6 +92,18 @@ void updateStatistics(double timeTaken, int charsTyped, int correctChars, double
     statsManager->updateStatistics(timeTaken, charsTyped, correctChars, wpm, accuracy);
 }
 
+// 加载用户的统计数据，文件损坏时告诉用户统计将重新开始
+void loadUserStatistics(const string &statsPath)
+{
+    statsManager->setStatsPath(statsPath);
+    if (!statsManager->loadStatistics() && !statsManager->getLoadError().empty())
+    {
+        showMessageDialog("Unable to load statistics: " + statsManager->getLoadError() +
+                              ". The file was renamed to .corrupt and statistics start from zero.",
+                          DIALOG_ERROR, "Statistics");
+    }
+}
+
 // 显示欢迎界面
 void showWelcomeScreen()
 {
@@ -93,8 +112,7 @@ void showWelcomeScreen()
         string statsPath = userManager->getCurrentUserStatsPath();
         if (!statsPath.empty())
         {
-            statsManager->setStatsPath(statsPath);
-            statsManager->loadStatistics();
+            loadUserStatistics(statsPath);
         }
     }
 
@@ -116,7 +134,12 @@ void showWelcomeScreen()
     updateStatusWindow("Press any key to continue...");
     wrefresh(contentWin);
 
-    getch();
+    // 改变终端大小不算按键，按新尺寸重绘
+    if (getch() == KEY_RESIZE)
+    {
+        resizeWindows();
+        showWelcomeScreen();
+    }
 }
 
 // 显示难度选择菜单
@@ -145,6 +168,12 @@ DifficultyLevel showDifficultyMenu()
     {
         int ch = getch();
 
+        if (ch == KEY_RESIZE)
+        {
+            resizeWindows();
+            return showDifficultyMenu();
+        }
+
         if (ch == KEY_ESC || ch == '0')
         {
             return CANCEL;
@@ -202,7 +231,18 @@ string getCustomText()
     {
         int ch = wgetch(contentWin);
 
-        if (ch == KEY_ESC)
+        if (ch == KEY_RESIZE)
+        {
+            // 按新尺寸重绘提示和已输入的内容
+            resizeWindows();
+            wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+            mvwprintw(contentWin, 2, 2, "Enter your custom text (max 255 characters):");
+            mvwprintw(contentWin, 3, 2, "Leave empty and press Enter to cancel");
+            wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+            mvwprintw(contentWin, 5, 2, "%s", input);
+            wrefresh(contentWin);
+        }
+        else if (ch == KEY_ESC)
         {
             cancelled = true;
             inputDone = true;
@@ -224,7 +264,7 @@ string getCustomText()
                 wrefresh(contentWin);
             }
         }
-        else if (isprint(ch) && inputPos < 255)
+        else if (ch < 256 && isprint(ch) && inputPos < 255)
         {
             input[inputPos++] = ch;
             waddch(contentWin, ch);
@@ -294,7 +334,7 @@ int showMainMenu(bool showUserOption)
     mvwprintw(contentWin, 10, 2, "F1: Help");
     wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
 
-    UserStats stats = statsManager->getStatistics();
+    const UserStats &stats = statsManager->getStatistics();
     if (statsManager->isStatsLoaded() && stats.sessionsCompleted > 0)
     {
         wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
@@ -314,6 +354,12 @@ int showMainMenu(bool showUserOption)
     {
         int ch = getch();
 
+        if (ch == KEY_RESIZE)
+        {
+            resizeWindows();
+            return showMainMenu(showUserOption);
+        }
+
         if (ch == KEY_F(1))
         {
             string helpText = "1-" + string(showUserOption ? "7" : "6") + ": Select menu option\n";
@@ -354,27 +400,80 @@ int showQuickStartMenu()
     mvwprintw(contentWin, 4, 2, "1. Keyboard Practice - Basic key position exercises");
     mvwprintw(contentWin, 5, 2, "2. Smart Text Practice - Auto-selected based on your history");
     mvwprintw(contentWin, 6, 2, "3. Custom Difficulty - Choose your own difficulty level");
-    mvwprintw(contentWin, 8, 2, "0. Return to main menu");
+    mvwprintw(contentWin, 7, 2, "4. Endless Practice - Continuous text for endurance training");
+    mvwprintw(contentWin, 8, 2, "5. Timed Test - Type as much as you can in a fixed time");
+    mvwprintw(contentWin, 9, 2, "6. Race - Race other users on this machine");
+    mvwprintw(contentWin, 11, 2, "0. Return to main menu");
     wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
 
-    updateStatusWindowWithHelp(statusWin, "Select option (0-3):", "ESC to return");
+    updateStatusWindowWithHelp(statusWin, "Select option (0-6):", "ESC to return");
     wrefresh(contentWin);
 
     while (true)
     {
         int ch = getch();
 
+        if (ch == KEY_RESIZE)
+        {
+            resizeWindows();
+            return showQuickStartMenu();
+        }
+
         if (ch == KEY_ESC || ch == '0')
         {
             return 0;
         }
-        else if (ch >= '1' && ch <= '3')
+        else if (ch >= '1' && ch <= '6')
         {
             return ch - '0';
         }
     }
 }
 
+// 显示限时测试时长选择菜单，返回秒数，0表示取消
+int showTimedTestMenu()
+{
+    const int durations[] = {15, 30, 60, 120};
+
+    updateHeaderWindow("TIMED TEST");
+    clearContentWindow();
+
+    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+    mvwprintw(contentWin, 2, 2, "Select test duration:");
+    wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+
+    wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+    for (int i = 0; i < 4; i++)
+    {
+        mvwprintw(contentWin, 4 + i, 2, "%d. %d seconds", i + 1, durations[i]);
+    }
+    mvwprintw(contentWin, 9, 2, "0. Return to main menu");
+    wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+
+    updateStatusWindowWithHelp("Enter your choice (0-4):", "Or press ESC to return");
+    wrefresh(contentWin);
+
+    while (true)
+    {
+        int ch = getch();
+
+        if (ch == KEY_RESIZE)
+        {
+            resizeWindows();
+            return showTimedTestMenu();
+        }
+
+        if (ch == KEY_ESC || ch == '0')
+        {
+            return 0;
+        }
+        else if (ch >= '1' && ch <= '4')
+        {
+            return durations[ch - '1'];
+        }
+    }
+}
+
 // 键位练习函数，修改为使用新的可视化键盘实现
 void keyboardPractice()
 {
@@ -387,7 +486,7 @@ void smartTextPractice()
 {
     DifficultyLevel difficulty = MEDIUM;
 
-    UserStats stats = statsManager->getStatistics();
+    const UserStats &stats = statsManager->getStatistics();
 
     if (statsManager->isStatsLoaded() && stats.sessionsCompleted > 0)
     {
@@ -449,7 +548,113 @@ void smartTextPractice()
         practiceText = corpusManager->extractPracticeSegment(fullText, wordCount);
     }
 
-    practiceSession(practiceText);
+    PracticeOptions options;
+    options.difficulty = matchingCorpus[randomIndex].difficulty;
+    options.corpusId = SessionHistory::corpusId(matchingCorpus[randomIndex].filename);
+    practiceSession(practiceText, options);
+}
+
+// 无尽模式文本生成器：每次调用从指定难度的语料中随机抽取一段
+// 在后台线程中调用，只读取语料库，不修改任何共享状态
+TextStreamProducer::Generator makeCorpusTextGenerator(DifficultyLevel difficulty, const string &customText)
+{
+    if (difficulty == CUSTOM)
+    {
+        return [customText]()
+        {
+            return customText;
+        };
+    }
+
+    vector<string> files;
+    for (const auto &corpus : corpusManager->getCorpusLibrary())
+    {
+        if (corpus.difficulty == difficulty)
+        {
+            files.push_back(corpus.filename);
+        }
+    }
+
+    int wordCount = corpusManager->getWordCountForDifficulty(difficulty);
+    auto gen = make_shared<mt19937>(random_device{}());
+
+    return [files, wordCount, difficulty, gen]() -> string
+    {
+        if (files.empty())
+        {
+            return "The quick brown fox jumps over the lazy dog. ";
+        }
+
+        uniform_int_distribution<> distrib(0, files.size() - 1);
+        string fullText = corpusManager->readCorpusFile(files[distrib(*gen)]);
+        if (difficulty == CHI)
+        {
+            return corpusManager->extractChinesePinyinSegment(fullText, wordCount);
+        }
+        return corpusManager->extractPracticeSegment(fullText, wordCount);
+    };
+}
+
+// 自适应文本使用的单词索引：由语料库中的英文文本建立，语料库变化后才重新建立
+const WordIndex &getWordIndex()
+{
+    static WordIndex wordIndex;
+    static size_t indexedCorpusCount = static_cast<size_t>(-1);
+
+    const vector<Corpus> &library = corpusManager->getCorpusLibrary();
+    if (library.size() != indexedCorpusCount)
+    {
+        wordIndex.clear();
+        for (const auto &corpus : library)
+        {
+            if (corpus.difficulty != CHI)
+            {
+                wordIndex.addText(corpusManager->readCorpusFile(corpus.filename));
+            }
+        }
+        wordIndex.finalize();
+        indexedCorpusCount = library.size();
+    }
+    return wordIndex;
+}
+
+// 无尽练习：文本从语料库中持续供给，直到用户按ESC结束或到达时限
+void endlessPractice(int timeLimitSeconds = 0)
+{
+    DifficultyLevel difficulty = showDifficultyMenu();
+    if (difficulty == CANCEL)
+    {
+        return;
+    }
+
+    string customText;
+    if (difficulty == CUSTOM)
+    {
+        customText = getCustomText();
+        if (customText.empty())
+        {
+            return;
+        }
+    }
+
+    TextStreamProducer producer(makeCorpusTextGenerator(difficulty, customText));
+    producer.start();
+
+    string firstChunk;
+    if (!producer.waitPop(firstChunk, 2000) || firstChunk.empty())
+    {
+        producer.stop();
+        showMessageDialog("Unable to load practice text from the corpus library.", DIALOG_ERROR, "Error");
+        return;
+    }
+
+    PracticeOptions options;
+    options.textStream = &producer;
+    options.timeLimitSeconds = timeLimitSeconds;
+    options.difficulty = difficulty;
+    practiceSession(firstChunk, options);
+
+    producer.stop();
 }
 
 // 处理快速开始菜单选择
@@ -470,579 +675,2127 @@ void handleQuickStart()
     case 3:
         practiceSession("");
         break;
+    case 4:
+        endlessPractice();
+        break;
+    case 5:
+    {
+        // 限时测试的文本同样由后台线程持续供给，保证在时限内不会打完
+        int testSeconds = showTimedTestMenu();
+        if (testSeconds > 0)
+        {
+            endlessPractice(testSeconds);
+        }
+        break;
+    }
+    case 6:
+        racePractice();
+        break;
     }
 }
 
-// 修改打字练习会话函数
-void practiceSession(string practiceText)
+// 结果界面上选择的下一步
+enum PracticeNext
 {
-    bool userCancelled = false;
+    PRACTICE_EXIT,       // 返回菜单
+    PRACTICE_RETRY,      // 用同一段文本重试
+    PRACTICE_NEXT_TEXT,  // 换同一难度的下一段文本
+    PRACTICE_RACE        // 与个人最佳比赛
+};
+
+// 每轮读取所有已到达的按键，逐个更新练习状态后只渲染一次
+const int MAX_KEY_BURST = 256;
+
+// 各轮练习之间复用的对象：每轮开始时只重置状态，已分配的缓冲区保留容量，
+// 连续重试数百次内存占用也保持不变
+struct PracticeContext
+{
+    TypingSession session;
+    SessionView view;
+    LatencyHistogram paintLatency;   // 按键从getch返回到屏幕刷新完成的时间
+    LatencyHistogram updateLatency;  // 每次按键更新练习状态的耗时
+    ReplayData nextGhost;            // 选择与个人最佳比赛时加载的回放
+    GhostTimeline ghost;             // 本轮的幽灵对手，为空表示不比赛
+    mt19937 adaptRng;
+    string chunk;                    // 无尽模式从队列中取出的文本
+    KeyEvent keyBurst[MAX_KEY_BURST];
+    int measuredKeys[MAX_KEY_BURST]; // 本轮中参与延迟统计的按键
+
+    // 本轮的设置
+    TextStreamProducer *textStream = nullptr; // 无尽模式：文本由后台线程持续供给，已输入完成的行会被丢弃
+    bool endless = false;
+    int timeLimitSeconds = 0;
+    bool timed = false;                       // 限时测试：到达截止时间立即结束，即使用户已停止输入
+    bool racing = false;
+    bool adaptive = false;
+    const WordIndex *wordIndex = nullptr;
+    StrictMode strictMode = STRICT_OFF;
+    bool skipSpace = true;
+    bool ignoreCase = false;
+
+    // 本轮的状态
+    bool exitRequested = false;
+    bool finishRequested = false;
+    bool timeUp = false;
+    bool idlePaused = false;
+    bool showLatency = false;                 // F12切换右上角的调试浮层
+    int overlayCol = 2;
+    steady_clock::time_point nextHudTime;
+    steady_clock::time_point nextGhostTime;
+    steady_clock::time_point deadline;        // 限时测试的截止时间，每次暂停结束后按暂停时长顺延
+    steady_clock::time_point lastActivity;
+    size_t ghostPos = SessionView::NO_GHOST;
+    size_t adaptedUntil = 0;                  // 上一段针对性文本的结束位置（绝对位置）
+    bool weakPending = false;                 // 本轮出现了错误按键
+    char32_t weakPrevious = 0;                // 最近一次错误按键的前一个字符和期望字符
+    char32_t weakChar = 0;
+
+    PracticeContext() : view(contentWin, 4, 2), adaptRng(random_device{}()) {}
+
+    bool isRunning() const
+    {
+        return (endless || !session.isFinished()) && !exitRequested && !finishRequested && !timeUp;
+    }
+};
 
-    if (practiceText.empty())
+// 一轮练习的成绩，写入统计后由结果界面显示
+struct PracticeResults
+{
+    double timeTaken = 0;
+    double pausedSeconds = 0;
+    size_t charsTyped = 0;
+    int correctChars = 0;
+    double accuracy = 0;
+    double wpm = 0;
+    KeyStatsTable sessionKeys;
+};
+
+// 从语料库中随机选取一段指定难度的练习文本（不包括自定义文本），没有可用文本时返回空字符串
+// corpusId不为空时返回文本来自的语料编号（语料库中没有该难度的文本时为0）
+string pickPracticeText(DifficultyLevel difficulty, uint32_t *corpusId = nullptr)
+{
+    if (corpusId != nullptr)
     {
-        DifficultyLevel difficulty = showDifficultyMenu();
+        *corpusId = 0;
+    }
 
-        if (difficulty == CANCEL)
-        {
-            return;
-        }
-        else if (difficulty == CUSTOM)
+    if (difficulty == CHI)
+    {
+        vector<Corpus> chineseCorpus;
+        for (const auto &corpus : corpusManager->getCorpusLibrary())
         {
-            practiceText = getCustomText();
-            if (practiceText.empty())
+            if (corpus.difficulty == CHI)
             {
-                userCancelled = true;
+                chineseCorpus.push_back(corpus);
             }
         }
-        else if (difficulty == CHI)
-        {
-            vector<Corpus> chineseCorpus;
-            for (const auto &corpus : corpusManager->getCorpusLibrary())
-            {
-                if (corpus.difficulty == CHI)
-                {
-                    chineseCorpus.push_back(corpus);
-                }
-            }
 
-            if (!chineseCorpus.empty())
-            {
-                random_device rd;
-                mt19937 gen(rd());
-                uniform_int_distribution<> distrib(0, chineseCorpus.size() - 1);
-                int selectedIndex = distrib(gen);
-
-                string fullText = corpusManager->readCorpusFile(chineseCorpus[selectedIndex].filename);
-                int charCount = corpusManager->getWordCountForDifficulty(CHI);
-                practiceText = corpusManager->extractChinesePinyinSegment(fullText, charCount);
-            }
-            else
-            {
-                showMessageDialog("No Chinese pinyin text found in corpus. Please import some Chinese pinyin files first.",
-                                  DIALOG_INFO, "Information");
-                return;
-            }
-        }
-        else
+        if (chineseCorpus.empty())
         {
-            vector<Corpus> matchingCorpus;
-            for (const auto &corpus : corpusManager->getCorpusLibrary())
-            {
-                if (corpus.difficulty == difficulty)
-                {
-                    matchingCorpus.push_back(corpus);
-                }
-            }
+            showMessageDialog("No Chinese pinyin text found in corpus. Please import some Chinese pinyin files first.",
+                              DIALOG_INFO, "Information");
+            return "";
+        }
 
-            if (!matchingCorpus.empty())
-            {
-                random_device rd;
-                mt19937 gen(rd());
-                uniform_int_distribution<> distrib(0, matchingCorpus.size() - 1);
-                int selectedIndex = distrib(gen);
-
-                string fullText = corpusManager->readCorpusFile(matchingCorpus[selectedIndex].filename);
-                int wordCount = corpusManager->getWordCountForDifficulty(difficulty);
-                practiceText = corpusManager->extractPracticeSegment(fullText, wordCount);
-            }
-            else
-            {
-                int wordCount = corpusManager->getWordCountForDifficulty(difficulty);
-                practiceText = generatePracticeText(wordCount);
-            }
+        random_device rd;
+        mt19937 gen(rd());
+        uniform_int_distribution<> distrib(0, chineseCorpus.size() - 1);
+        int selectedIndex = distrib(gen);
+        if (corpusId != nullptr)
+        {
+            *corpusId = SessionHistory::corpusId(chineseCorpus[selectedIndex].filename);
         }
-    }
 
-    if (userCancelled || practiceText.empty())
-    {
-        return;
+        string fullText = corpusManager->readCorpusFile(chineseCorpus[selectedIndex].filename);
+        int charCount = corpusManager->getWordCountForDifficulty(CHI);
+        return corpusManager->extractChinesePinyinSegment(fullText, charCount);
     }
 
-    updateHeaderWindow("TYPING PRACTICE");
-    clearContentWindow();
-
-    string userInput;
-    int currentPos = 0;
-    bool exitRequested = false;
-
-    map<char, int> sessionErrors;
-
-    auto startTime = high_resolution_clock::now();
-
-    int maxCharsPerLine = getmaxx(contentWin) - 6;
-    vector<string> textLines;
-
-    string remainingText = practiceText;
-    while (!remainingText.empty())
+    vector<Corpus> matchingCorpus;
+    for (const auto &corpus : corpusManager->getCorpusLibrary())
     {
-        if (remainingText.length() <= maxCharsPerLine)
+        if (corpus.difficulty == difficulty)
         {
-            textLines.push_back(remainingText);
-            remainingText.clear();
+            matchingCorpus.push_back(corpus);
         }
-        else
-        {
-            int breakPos = maxCharsPerLine;
-            while (breakPos > 0 && remainingText[breakPos] != ' ')
-            {
-                breakPos--;
-            }
+    }
 
-            if (breakPos == 0)
-            {
-                breakPos = maxCharsPerLine;
-            }
+    int wordCount = corpusManager->getWordCountForDifficulty(difficulty);
+    if (matchingCorpus.empty())
+    {
+        return generatePracticeText(wordCount);
+    }
 
-            textLines.push_back(remainingText.substr(0, breakPos));
-            remainingText = remainingText.substr(breakPos);
-        }
+    random_device rd;
+    mt19937 gen(rd());
+    uniform_int_distribution<> distrib(0, matchingCorpus.size() - 1);
+    int selectedIndex = distrib(gen);
+    if (corpusId != nullptr)
+    {
+        *corpusId = SessionHistory::corpusId(matchingCorpus[selectedIndex].filename);
     }
 
+    string fullText = corpusManager->readCorpusFile(matchingCorpus[selectedIndex].filename);
+    return corpusManager->extractPracticeSegment(fullText, wordCount);
+}
+
+// 练习文本上方的说明（终端大小改变后重绘）
+void drawPracticeHeading(const PracticeContext &context)
+{
     wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
-    mvwprintw(contentWin, 2, 2, "Type the following text:");
+    if (context.timed)
+    {
+        mvwprintw(contentWin, 2, 2, "Type the following text (%d second test):", context.timeLimitSeconds);
+    }
+    else
+    {
+        mvwprintw(contentWin, 2, 2, context.endless ? "Type the following text (endless mode, ESC to finish):"
+                                                    : "Type the following text:");
+    }
 
-    bool skipSpace = settingsManager->getBoolSetting(SettingKeys::SKIP_SPACE, true);
-    bool ignoreCase = settingsManager->getBoolSetting(SettingKeys::IGNORE_CASE, false);
+    // 严格模式标记在标题之后
+    if (context.strictMode == STRICT_STOP_ON_ERROR)
+    {
+        wprintw(contentWin, " [stop on error]");
+    }
+    else if (context.strictMode == STRICT_MUST_CORRECT)
+    {
+        wprintw(contentWin, " [errors must be corrected]");
+    }
 
     int line = 3;
 
-    if (skipSpace)
+    if (context.skipSpace)
     {
         mvwprintw(contentWin, line++, 2, "(Spaces will be skipped automatically)");
     }
 
-    if (ignoreCase)
+    if (context.ignoreCase)
     {
         mvwprintw(contentWin, line++, 2, "(Case differences will be ignored)");
     }
     wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+}
 
-    wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
-    for (size_t i = 0; i < textLines.size(); i++)
-    {
-        mvwprintw(contentWin, 4 + i, 2, "%s", textLines[i].c_str());
-    }
-    wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
-
-    int currentLine = 0;
-    wmove(contentWin, 4 + currentLine, 2);
+// 读取本轮的设置并重置状态，绘制练习界面
+void startPracticeRound(PracticeContext &context, const string &practiceText, const PracticeOptions &options)
+{
+    updateHeaderWindow("TYPING PRACTICE");
+    clearContentWindow();
 
-    wattron(contentWin, COLOR_PAIR(COLOR_CURRENT));
-    waddch(contentWin, practiceText[0]);
-    wattroff(contentWin, COLOR_PAIR(COLOR_CURRENT));
+    context.textStream = options.textStream;
+    context.endless = (context.textStream != nullptr);
+    context.timeLimitSeconds = options.timeLimitSeconds;
+    context.timed = (options.timeLimitSeconds > 0);
+
+    int strictSetting = settingsManager->getIntSetting(SettingKeys::STRICT_MODE, STRICT_OFF);
+    context.strictMode = (strictSetting == STRICT_STOP_ON_ERROR || strictSetting == STRICT_MUST_CORRECT)
+                             ? static_cast<StrictMode>(strictSetting)
+                             : STRICT_OFF;
+    context.skipSpace = settingsManager->getBoolSetting(SettingKeys::SKIP_SPACE, true);
+    context.ignoreCase = settingsManager->getBoolSetting(SettingKeys::IGNORE_CASE, false);
+
+    // 幽灵对手：个人最佳记录按同样的练习时间推进
+    context.ghost = (options.ghost != nullptr && !context.endless) ? GhostTimeline(*options.ghost) : GhostTimeline();
+    context.racing = !context.ghost.isEmpty();
+
+    // 与幽灵对手比赛时文本必须与个人最佳一致，不做调整
+    context.adaptive = !context.racing && settingsManager->getBoolSetting(SettingKeys::ADAPTIVE_TEXT, false);
+    context.wordIndex = context.adaptive ? &getWordIndex() : nullptr;
+
+    drawPracticeHeading(context);
+
+    auto startTime = steady_clock::now();
+
+    // 练习状态与界面绘制分离：按键只更新会话状态，由SessionView统一绘制
+    context.session.setStrictMode(context.strictMode);
+    context.session.start(practiceText, context.skipSpace, context.ignoreCase, startTime);
+    context.view.layout(context.session, getmaxx(contentWin) - 6);
+    context.view.drawAll(context.session);
+    context.session.clearDirty();
+
+    context.exitRequested = false;
+    context.finishRequested = false;
+    context.timeUp = false;
+    context.idlePaused = false;
+    context.showLatency = false;
+    context.overlayCol = max(2, getmaxx(contentWin) - 44);
+    context.nextHudTime = startTime;
+    context.nextGhostTime = startTime;
+    context.deadline = startTime + seconds(options.timeLimitSeconds);
+    context.lastActivity = startTime;
+    context.ghostPos = SessionView::NO_GHOST;
+    context.adaptedUntil = 0;
+    context.weakPending = false;
+    context.weakPrevious = 0;
+    context.weakChar = 0;
+    context.paintLatency.reset();
+    context.updateLatency.reset();
 
-    updateStatusWindowWithHelp("Progress: 0%", "ESC: Return to Menu  F1: Help");
+    curs_set(0);
+    context.view.refresh();
+}
 
-    wrefresh(contentWin);
+// 右上角的延迟调试浮层
+void drawLatencyOverlay(PracticeContext &context)
+{
+    const LatencyHistogram &paint = context.paintLatency;
+    const LatencyHistogram &update = context.updateLatency;
 
-    curs_set(0);
+    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+    mvwprintw(contentWin, 1, context.overlayCol, "%-42s", "Latency        p50      p99      max");
+    mvwprintw(contentWin, 2, context.overlayCol, "Key->paint %6.2fms %6.2fms %6.2fms",
+              paint.percentile(50) / 1e6, paint.percentile(99) / 1e6, paint.getMax() / 1e6);
+    mvwprintw(contentWin, 3, context.overlayCol, "Update     %6.1fus %6.1fus %6.1fus",
+              update.percentile(50) / 1e3, update.percentile(99) / 1e3, update.getMax() / 1e3);
+    wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
+    context.view.refresh();
+}
 
-    while (currentPos < practiceText.size() && !exitRequested)
+void clearLatencyOverlay(PracticeContext &context)
+{
+    for (int row = 1; row <= 3; row++)
     {
-        if (skipSpace && practiceText[currentPos] == ' ')
-        {
-            int posLine = 0;
-            int posInLine = currentPos;
-
-            for (size_t i = 0; i < textLines.size(); i++)
-            {
-                if (posInLine < textLines[i].length())
-                {
-                    posLine = i;
-                    break;
-                }
-                posInLine -= textLines[i].length();
-            }
+        mvwprintw(contentWin, row, context.overlayCol, "%42s", "");
+    }
+    context.view.refresh();
+}
 
-            wmove(contentWin, 4 + posLine, 2 + posInLine);
-            wattron(contentWin, COLOR_PAIR(COLOR_CORRECT));
-            waddch(contentWin, ' ');
-            wattroff(contentWin, COLOR_PAIR(COLOR_CORRECT));
+// 实时统计HUD：按固定间隔刷新，按键本身不会触发状态栏重绘
+void drawPracticeHud(PracticeContext &context, steady_clock::time_point now)
+{
+    TypingSession &session = context.session;
 
-            userInput += ' ';
-            currentPos++;
+    int progress = context.endless ? -1 : static_cast<int>(session.getPosition() * 100 / session.getText().size());
+    string hud = session.getLiveStats().formatStatusLine(now, progress, session.getScore());
+    if (context.timed)
+    {
+        long long remainingMs = max(0LL, static_cast<long long>(duration_cast<milliseconds>(context.deadline - now).count()));
+        char remaining[32];
+        snprintf(remaining, sizeof(remaining), "Left %lld.%llds | ", remainingMs / 1000, remainingMs % 1000 / 100);
+        hud = remaining + hud;
+    }
+    if (session.isAtEnd() && !session.isFinished())
+    {
+        // 必须改正模式：已到文本末尾但还有未改正的错误
+        hud = "Fix " + to_string(session.getOutstandingErrors()) + " error(s) to finish | " + hud;
+    }
+    if (context.racing)
+    {
+        // 领先（正数）或落后于个人最佳的字符数
+        long long lead = static_cast<long long>(session.getPosition()) -
+                         static_cast<long long>(context.ghostPos == SessionView::NO_GHOST ? session.getText().size() : context.ghostPos);
+        hud = "Best " + string(lead >= 0 ? "+" : "") + to_string(lead) + " | " + hud;
+    }
+    updateStatusWindowWithHelp(hud, (context.endless && !context.timed) ? "ESC: Finish  F1: Help  F2: Pause" : "ESC: Menu  F1: Help  F2: Pause");
 
-            if (currentPos >= practiceText.size())
-            {
-                break;
-            }
+    if (context.showLatency)
+    {
+        drawLatencyOverlay(context);
+    }
+}
 
-            posLine = 0;
-            posInLine = currentPos;
-            for (size_t i = 0; i < textLines.size(); i++)
-            {
-                if (posInLine < textLines[i].length())
-                {
-                    posLine = i;
-                    break;
-                }
-                posInLine -= textLines[i].length();
-            }
+// 自适应文本：某个字符或双字母组合的错误率超过阈值时，把视口下方尚未显示的一段文本
+// 替换为富含该组合的单词。只重新断行被替换的行及之后的行，已显示的行和光标不受影响
+const uint32_t ADAPT_MIN_SAMPLES = 4;    // 至少输入这么多次才判断错误率
+const uint32_t ADAPT_ERROR_PERCENT = 30; // 错误率阈值
+const size_t ADAPT_CHARS = 60;           // 每次替换的文本长度（字符）
 
-            wmove(contentWin, 4 + posLine, 2 + posInLine);
-            wattron(contentWin, COLOR_PAIR(COLOR_CURRENT));
-            waddch(contentWin, practiceText[currentPos]);
-            wattroff(contentWin, COLOR_PAIR(COLOR_CURRENT));
+bool isWeakKey(uint32_t count, uint32_t errors)
+{
+    return count >= ADAPT_MIN_SAMPLES && errors * 100 >= count * ADAPT_ERROR_PERCENT;
+}
 
-            int progress = (currentPos * 100) / practiceText.size();
-            updateStatusWindowWithHelp("Progress: " + to_string(progress) + "%", "ESC: Menu");
+void adaptPracticeText(PracticeContext &context)
+{
+    TypingSession &session = context.session;
+    SessionView &view = context.view;
+    const WordIndex &wordIndex = *context.wordIndex;
+    char32_t weakPrevious = context.weakPrevious;
+    char32_t weakChar = context.weakChar;
 
-            wrefresh(contentWin);
-            continue;
-        }
+    context.weakPending = false;
 
-        int ch = getch();
+    // 上一段针对性文本还没有输入完成时不再替换
+    if (session.getDiscardedCount() + session.getPosition() < context.adaptedUntil || weakChar >= 128)
+    {
+        return;
+    }
 
-        switch (ch)
+    const TypingAnalysis &analysis = session.getAnalysis();
+    const vector<uint32_t> *candidates = nullptr;
+    if (weakPrevious > U' ' && weakPrevious < 128)
+    {
+        BigramStat bigram = analysis.getBigram(static_cast<unsigned char>(weakPrevious), static_cast<unsigned char>(weakChar));
+        if (isWeakKey(bigram.count, bigram.errors))
         {
-        case KEY_ESC:
-            if (showConfirmDialog("Are you sure you want to exit?", "Confirm Exit"))
+            candidates = &wordIndex.wordsWithBigram(static_cast<char>(weakPrevious), static_cast<char>(weakChar));
+        }
+    }
+    if ((candidates == nullptr || candidates->empty()) &&
+        isWeakKey(analysis.getCharCount(static_cast<unsigned char>(weakChar)), analysis.getCharErrors(static_cast<unsigned char>(weakChar))))
+    {
+        candidates = &wordIndex.wordsWithChar(static_cast<char>(weakChar));
+    }
+    if (candidates == nullptr || candidates->empty())
+    {
+        return;
+    }
+
+    size_t line = view.getFirstHiddenLine();
+    if (line >= view.getLineCount())
+    {
+        return;
+    }
+
+    // 替换的一段在原文的空格处结束，之后的原文保持不变
+    const u32string &text = session.getText();
+    size_t from = view.getLineStart(line);
+    size_t to = min(from + ADAPT_CHARS, text.size());
+    while (to < text.size() && text[to] != U' ')
+    {
+        to++;
+    }
+
+    string drill = wordIndex.makeText(*candidates, to - from, context.adaptRng);
+    if (session.replaceText(from, to, drill))
+    {
+        view.relayoutFrom(session, line);
+        context.adaptedUntil = session.getDiscardedCount() + from + drill.size();
+    }
+}
+
+// 无尽模式下剩余文本不足时从队列中取出新文本追加到末尾
+const size_t REFILL_THRESHOLD = 400;
+
+void refillPracticeText(PracticeContext &context)
+{
+    TypingSession &session = context.session;
+    bool appended = false;
+    while (session.getText().size() - session.getPosition() < REFILL_THRESHOLD && context.textStream->tryPop(context.chunk))
+    {
+        session.appendText(context.chunk);
+        context.view.relayoutFrom(session, context.view.getLineCount());
+        appended = true;
+    }
+
+    if (appended)
+    {
+        context.view.drawAll(session);
+        session.clearDirty();
+    }
+}
+
+// 暂停：按F2手动暂停，对话框打开期间以及超过IDLE_TIMEOUT没有按键时自动暂停。
+// 暂停时长从成绩、实时统计、幽灵对手和限时测试的截止时间中扣除。
+// 限时测试不做空闲检测，停止输入时也按时结束
+const auto IDLE_TIMEOUT = seconds(10);
+
+void resumePractice(PracticeContext &context, steady_clock::time_point time)
+{
+    context.deadline += context.session.resume(time);
+    context.lastActivity = time;
+    context.nextHudTime = time;
+    context.nextGhostTime = time;
+}
+
+// 终端大小改变：调整窗口后按新宽度重新断行，输入状态、计时和幽灵光标都保留在会话和视图中，
+// 重绘后与改变前一致
+void handlePracticeResize(PracticeContext &context)
+{
+    resizeWindows();
+    drawPracticeHeading(context);
+    context.view.resize(context.session, getmaxx(contentWin) - 6);
+    context.view.drawAll(context.session);
+    context.session.clearDirty();
+    context.overlayCol = max(2, getmaxx(contentWin) - 44);
+    if (context.showLatency)
+    {
+        drawLatencyOverlay(context);
+    }
+    context.view.refresh();
+    context.nextHudTime = steady_clock::now();
+}
+
+// 暂停时不需要定时器，阻塞等待任意键继续（该按键只用于继续，不作为输入）
+void waitForResume(PracticeContext &context)
+{
+    updateStatusWindowWithHelp(context.idlePaused ? "Paused (no input) - paused time is not scored"
+                                                  : "Paused - paused time is not scored",
+                               "Any key: Resume");
+    KeyEvent resumeKey;
+    readKeyBurst(&resumeKey, 1, -1);
+    if (resumeKey.isKeyCode && resumeKey.key == KEY_RESIZE)
+    {
+        handlePracticeResize(context);
+        return;
+    }
+    resumePractice(context, resumeKey.time);
+}
+
+// 处理到期的定时事件（测试截止、空闲暂停、幽灵移动、HUD刷新），然后阻塞等待按键，
+// 最多等到下一个定时事件。返回读到的按键数，读到的按键在context.keyBurst中
+int waitForPracticeKeys(PracticeContext &context)
+{
+    // 限时测试需要显示十分之一秒的剩余时间，HUD刷新间隔缩短为100ms
+    const auto HUD_INTERVAL = milliseconds(context.timed ? 100 : 250);
+    // 幽灵由定时器驱动重绘（约30帧/秒），每帧只二分查找一次位置，位置变化时重绘新旧两个字符
+    const auto GHOST_INTERVAL = milliseconds(33);
+    TypingSession &session = context.session;
+
+    auto now = steady_clock::now();
+    if (context.timed && now >= context.deadline)
+    {
+        context.timeUp = true;
+        return 0;
+    }
+
+    // 空闲检测：暂停从最后一次按键开始，空闲的整段时间都不计入
+    if (!context.timed && now - context.lastActivity >= IDLE_TIMEOUT)
+    {
+        session.pause(context.lastActivity);
+        context.idlePaused = true;
+        return 0;
+    }
+
+    if (context.racing && now >= context.nextGhostTime)
+    {
+        size_t position = context.ghost.positionAt(duration_cast<milliseconds>(session.activeTime(now)).count());
+        if (position != context.ghostPos)
+        {
+            context.ghostPos = position;
+            context.view.setGhostPosition(session, position);
+            context.view.refresh();
+        }
+        context.nextGhostTime = now + GHOST_INTERVAL;
+    }
+
+    if (now >= context.nextHudTime)
+    {
+        drawPracticeHud(context, now);
+        context.nextHudTime = now + HUD_INTERVAL;
+    }
+
+    auto nextTimer = (context.timed && context.deadline < context.nextHudTime) ? context.deadline : context.nextHudTime;
+    if (context.racing && context.nextGhostTime < nextTimer)
+    {
+        nextTimer = context.nextGhostTime;
+    }
+    if (!context.timed && context.lastActivity + IDLE_TIMEOUT < nextTimer)
+    {
+        nextTimer = context.lastActivity + IDLE_TIMEOUT;
+    }
+    int waitMs = static_cast<int>(duration_cast<milliseconds>(nextTimer - now).count()) + 1;
+    return readKeyBurst(context.keyBurst, MAX_KEY_BURST, waitMs);
+}
+
+// ESC或F1：对话框自己读取输入，打开期间暂停计时
+void showPracticeDialog(PracticeContext &context, bool isEsc)
+{
+    if (isEsc && context.endless && !context.timed)
+    {
+        if (showConfirmDialog("Finish the endless session and see results?", "Finish Session"))
+        {
+            context.finishRequested = true;
+        }
+    }
+    else if (isEsc)
+    {
+        if (showConfirmDialog("Are you sure you want to exit?", "Confirm Exit"))
+        {
+            context.exitRequested = true;
+        }
+    }
+    else
+    {
+        showMessageDialog(
+            "ESC: Return to menu\n"
+            "Backspace: Delete last character\n"
+            "F2: Pause (also pauses after 10 seconds without input)\n"
+            "F12: Show/hide latency overlay\n"
+            "Type the displayed text as fast and accurately as possible.",
+            DIALOG_INFO, "Help");
+    }
+    resumePractice(context, steady_clock::now());
+}
+
+// 逐个处理一轮读到的按键并更新练习状态，最后只渲染一次
+void handlePracticeKeys(PracticeContext &context, int keyCount)
+{
+    TypingSession &session = context.session;
+    SessionView &view = context.view;
+    KeyEvent *keyBurst = context.keyBurst;
+
+    int measuredCount = 0;
+    bool dialogShown = false;  // 弹出对话框的一轮不统计延迟
+
+    for (int k = 0; k < keyCount && context.isRunning(); k++)
+    {
+        int ch = keyBurst[k].key;
+        bool isKeyCode = keyBurst[k].isKeyCode;
+
+        // 截止时间之后到达的按键不计入成绩
+        if (context.timed && keyBurst[k].time >= context.deadline)
+        {
+            context.timeUp = true;
+            break;
+        }
+
+        // 改变终端大小不算作输入
+        if (isKeyCode && ch == KEY_RESIZE)
+        {
+            handlePracticeResize(context);
+            continue;
+        }
+        context.lastActivity = keyBurst[k].time;
+
+        if (isKeyCode && ch == KEY_F(2))
+        {
+            // 之后的按键放回输入队列，其中第一个用于继续
+            session.pause(keyBurst[k].time);
+            context.idlePaused = false;
+            for (int r = keyCount - 1; r > k; r--)
+            {
+                unreadKey(keyBurst[r]);
+            }
+            keyCount = k + 1;
+            continue;
+        }
+
+        if (isKeyCode && ch == KEY_F(12))
+        {
+            context.showLatency = !context.showLatency;
+            if (context.showLatency)
+            {
+                drawLatencyOverlay(context);
+            }
+            else
+            {
+                clearLatencyOverlay(context);
+            }
+            continue;
+        }
+
+        bool isEsc = !isKeyCode && ch == KEY_ESC;
+        if (isEsc || (isKeyCode && ch == KEY_F(1)))
+        {
+            // 先渲染已处理的按键，再将剩余按键放回输入队列
+            dialogShown = true;
+            session.pause(keyBurst[k].time);
+            view.drawDirty(session);
+            view.refresh();
+            for (int r = keyCount - 1; r > k; r--)
             {
-                exitRequested = true;
+                unreadKey(keyBurst[r]);
             }
+            keyCount = k + 1;
+            showPracticeDialog(context, isEsc);
             continue;
+        }
 
-        case KEY_F(1):
-            showMessageDialog(
-                "ESC: Return to menu\n"
-                "Backspace: Delete last character\n"
-                "Type the displayed text as fast and accurately as possible.",
-                DIALOG_INFO, "Help");
+        auto updateStart = steady_clock::now();
+
+        if (isKeyCode ? (ch == KEY_BACKSPACE) : (ch == KEY_BACKSPACE_ALT || ch == 127))
+        {
+            session.backspace(keyBurst[k].time);
+            context.updateLatency.record(steady_clock::now() - updateStart);
+            context.measuredKeys[measuredCount++] = k;
             continue;
         }
 
-        if (ch == KEY_BACKSPACE || ch == KEY_BACKSPACE_ALT || ch == 127)
+        // 可输入的字符：控制字符以外的任意码位
+        if (!isKeyCode && ch >= 0x20 && ch != 0x7F && !session.isAtEnd())
+        {
+            size_t position = session.getPosition();
+            char32_t expectedChar = session.getText()[position];
+            if (session.typeChar(static_cast<char32_t>(ch), keyBurst[k].time) == TYPE_INCORRECT)
+            {
+                context.weakPending = context.adaptive;
+                context.weakPrevious = (position > 0) ? session.getText()[position - 1] : 0;
+                context.weakChar = expectedChar;
+            }
+            context.updateLatency.record(steady_clock::now() - updateStart);
+            context.measuredKeys[measuredCount++] = k;
+        }
+    }
+
+    view.drawDirty(session);
+
+    // 视口滚动后丢弃上方已输入完成的行，内存占用保持恒定
+    if (context.endless && view.getFirstVisibleLine() > 0)
+    {
+        session.discardPrefix(view.discardLinesAboveViewport());
+    }
+
+    // 在视口滚动之后调整，被替换的行一定还没有显示
+    if (context.weakPending)
+    {
+        adaptPracticeText(context);
+    }
+
+    view.refresh();
+
+    if (!dialogShown)
+    {
+        auto painted = steady_clock::now();
+        for (int m = 0; m < measuredCount; m++)
+        {
+            context.paintLatency.record(painted - keyBurst[context.measuredKeys[m]].time);
+        }
+    }
+}
+
+// 保存回放并把本轮成绩写入用户统计和练习历史
+PracticeResults recordPracticeResults(const PracticeContext &context, const PracticeOptions &options)
+{
+    const TypingSession &session = context.session;
+
+    // 无尽模式的文本已被丢弃，无法保存回放；回放由后台线程写入，不推迟结果界面
+    if (!context.endless)
+    {
+        replayManager->saveSession(session);
+    }
+
+    // 成绩在练习过程中已增量统计完毕，这里直接读取
+    const TypingScore &score = session.getScore();
+    PracticeResults results;
+    results.charsTyped = score.getTypedCount();
+
+    // 以最后一次按键的时间作为结束时间，不计入渲染耗时；限时测试以截止时间结束
+    // 暂停的时间（对话框、F2和空闲）精确扣除
+    auto activeTime = context.timeUp ? session.activeTime(context.deadline) : session.activeTimeAtLastKey();
+    results.timeTaken = duration_cast<milliseconds>(activeTime).count() / 1000.0;
+    results.pausedSeconds = duration_cast<milliseconds>(session.getPausedDuration()).count() / 1000.0;
+    results.correctChars = static_cast<int>(score.getCorrectCount());
+    results.accuracy = score.accuracy();
+    results.wpm = score.rawWPM(results.timeTaken);
+
+    // 将本次练习的常错单词和双字母组合累计到用户统计中
+    const TypingAnalysis &analysis = session.getAnalysis();
+    for (const WordStat &word : analysis.errorProneWords(analysis.getWordCount()))
+    {
+        statsManager->updateErrorWord(word.word, word.errors);
+    }
+    for (const BigramStat &bigram : analysis.errorProneBigrams(TypingAnalysis::BIGRAM_TABLE_SIZE))
+    {
+        // 用户统计只保存ASCII字符组成的组合
+        if (bigram.first < 128 && bigram.second < 128)
+        {
+            statsManager->updateErrorBigram(static_cast<char>(bigram.first), static_cast<char>(bigram.second), bigram.errors);
+        }
+    }
+
+    // 每个键的次数、错误和延迟在练习结束后从逐键记录中一次统计（无尽模式下丢弃文本时已折算的部分直接合并），
+    // 练习中的按键不做额外工作
+    results.sessionKeys = session.getKeyStats();
+    statsManager->mergeKeyStats(results.sessionKeys);
+
+    statsManager->updateStatistics(results.timeTaken, results.charsTyped, results.correctChars, results.wpm, results.accuracy);
+
+    // 追加到练习历史
+    SessionRecord record;
+    record.timestamp = static_cast<int64_t>(time(nullptr));
+    record.corpusId = options.corpusId;
+    record.durationMs = static_cast<uint32_t>(duration_cast<milliseconds>(activeTime).count());
+    record.charsTyped = static_cast<uint32_t>(results.charsTyped);
+    record.correctChars = static_cast<uint32_t>(results.correctChars);
+    record.rawWPM = static_cast<float>(results.wpm);
+    record.netWPM = static_cast<float>(score.netWPM(results.timeTaken));
+    record.accuracy = static_cast<float>(results.accuracy);
+    record.mode = context.timed ? PRACTICE_MODE_TIMED : context.endless ? PRACTICE_MODE_ENDLESS
+                : context.racing ? PRACTICE_MODE_GHOST : PRACTICE_MODE_TEXT;
+    record.difficulty = static_cast<uint8_t>(options.difficulty);
+    statsManager->recordSession(record);
+
+    return results;
+}
+
+// 结果界面（终端大小改变后按新尺寸重绘）
+void drawPracticeResults(const PracticeContext &context, const PracticeResults &results, bool canChangeText)
+{
+    const TypingSession &session = context.session;
+    const TypingScore &score = session.getScore();
+    const TypingAnalysis &analysis = session.getAnalysis();
+    double wpm = results.wpm;
+    double accuracy = results.accuracy;
+
+    updateHeaderWindow("SESSION RESULTS");
+    clearContentWindow();
+
+    wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+    mvwprintw(contentWin, 2, 2, "Time taken: %.1f seconds", results.timeTaken);
+    if (context.racing)
+    {
+        wprintw(contentWin, " (personal best %.1f)", context.ghost.getDurationMs() / 1000.0);
+    }
+    if (results.pausedSeconds >= 0.1)
+    {
+        wprintw(contentWin, " (%.1f s paused)", results.pausedSeconds);
+    }
+    mvwprintw(contentWin, 3, 2, "Characters typed: %zu", results.charsTyped);
+    mvwprintw(contentWin, 4, 2, "Correct characters: %d", results.correctChars);
+    mvwprintw(contentWin, 5, 2, "Accuracy: %.1f%%", accuracy);
+    mvwprintw(contentWin, 6, 2, "Typing speed: %.1f WPM (net %.1f)", wpm, score.netWPM(results.timeTaken));
+    mvwprintw(contentWin, 7, 2, "Uncorrected errors: %zu (mistyped keys: %zu)", score.getErrorCount(), score.getMistakeCount());
+
+    // 错误字符从本次练习的错误统计表中选出，ASCII字符同时显示该键正确输入时的平均间隔
+    RankedEntry topErrors[5];
+    size_t errorCount = session.topErrors(topErrors, 5);
+    if (errorCount > 0)
+    {
+        mvwprintw(contentWin, 8, 2, "Most common errors:");
+
+        int row = 9;
+        for (size_t i = 0; i < errorCount; ++i)
         {
-            if (currentPos > 0 && !userInput.empty())
+            char32_t ch = topErrors[i].index;
+            mvwprintw(contentWin, row, 2, "Character '%s': %u times", Utf8::encode(ch).c_str(), topErrors[i].value);
+            if (ch < KeyStatsTable::KEY_COUNT && results.sessionKeys.getLatencySamples(static_cast<unsigned char>(ch)) > 0)
             {
-                int posLine = 0;
-                int posInLine = currentPos;
+                wprintw(contentWin, " (%.0f ms)", results.sessionKeys.getMeanLatency(static_cast<unsigned char>(ch)));
+            }
+            row++;
+        }
+    }
+
+    if (wpm > 0)
+    {
+        mvwprintw(contentWin, 15, 2, "Performance Analysis:");
+
+        string speedComment;
+        if (wpm < 20)
+        {
+            speedComment = "Beginner level. Keep practicing!";
+        }
+        else if (wpm < 40)
+        {
+            speedComment = "Developing skills. Good progress!";
+        }
+        else if (wpm < 60)
+        {
+            speedComment = "Intermediate level. Well done!";
+        }
+        else if (wpm < 80)
+        {
+            speedComment = "Advanced level. Impressive!";
+        }
+        else
+        {
+            speedComment = "Expert level. Amazing speed!";
+        }
+
+        string accuracyComment;
+        if (accuracy < 90)
+        {
+            accuracyComment = "Focus on accuracy over speed.";
+        }
+        else if (accuracy < 95)
+        {
+            accuracyComment = "Good accuracy. Keep refining.";
+        }
+        else if (accuracy < 98)
+        {
+            accuracyComment = "Excellent accuracy!";
+        }
+        else
+        {
+            accuracyComment = "Perfect! Maintain this precision.";
+        }
+
+        mvwprintw(contentWin, 16, 4, "%s", speedComment.c_str());
+        mvwprintw(contentWin, 17, 4, "%s", accuracyComment.c_str());
+    }
+
+    // 右侧一栏显示最慢和错误最多的单词与双字母组合（空格显示为'_'）
+    int col = getmaxx(contentWin) / 2;
+    int row = 2;
+    auto showPair = [](const BigramStat &bigram)
+    {
+        return Utf8::encode(bigram.first == U' ' ? U'_' : bigram.first) +
+               Utf8::encode(bigram.second == U' ' ? U'_' : bigram.second);
+    };
+
+    vector<WordStat> slowWords = analysis.slowestWords(3);
+    if (!slowWords.empty())
+    {
+        mvwprintw(contentWin, row++, col, "Slowest words:");
+        for (const WordStat &word : slowWords)
+        {
+            mvwprintw(contentWin, row++, col + 2, "%s %.0f ms/char", Utf8::fitColumns(word.word, 16).c_str(), word.msPerChar);
+        }
+        row++;
+    }
+
+    vector<WordStat> errorWords = analysis.errorProneWords(3);
+    if (!errorWords.empty())
+    {
+        mvwprintw(contentWin, row++, col, "Most mistyped words:");
+        for (const WordStat &word : errorWords)
+        {
+            mvwprintw(contentWin, row++, col + 2, "%s %d errors", Utf8::fitColumns(word.word, 16).c_str(), word.errors);
+        }
+        row++;
+    }
+
+    vector<BigramStat> slowBigrams = analysis.slowestBigrams(3);
+    if (!slowBigrams.empty())
+    {
+        mvwprintw(contentWin, row++, col, "Slowest key pairs:");
+        for (const BigramStat &bigram : slowBigrams)
+        {
+            mvwprintw(contentWin, row++, col + 2, "%s  %.0f ms (x%u)",
+                      showPair(bigram).c_str(), bigram.avgLatencyMs, bigram.count);
+        }
+        row++;
+    }
+
+    vector<BigramStat> errorBigrams = analysis.errorProneBigrams(3);
+    if (!errorBigrams.empty())
+    {
+        mvwprintw(contentWin, row++, col, "Most mistyped key pairs:");
+        for (const BigramStat &bigram : errorBigrams)
+        {
+            mvwprintw(contentWin, row++, col + 2, "%s  %u errors",
+                      showPair(bigram).c_str(), bigram.errors);
+        }
+    }
+
+    wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+
+    // 延迟报告：按键到屏幕刷新完成的分位数
+    const LatencyHistogram &paintLatency = context.paintLatency;
+    if (paintLatency.getCount() > 0)
+    {
+        mvwprintw(contentWin, getmaxy(contentWin) - 6, 2, "Input latency: p50 %.2f ms, p99 %.2f ms, max %.2f ms (update p99 %.1f us)",
+                  paintLatency.percentile(50) / 1e6, paintLatency.percentile(99) / 1e6, paintLatency.getMax() / 1e6,
+                  context.updateLatency.percentile(99) / 1e3);
+    }
+
+    if (!context.endless)
+    {
+        mvwprintw(contentWin, getmaxy(contentWin) - 5, 2, "G: Race against your personal best");
+        mvwprintw(contentWin, getmaxy(contentWin) - 4, 2, "R: Retry with same text");
+        if (canChangeText)
+        {
+            mvwprintw(contentWin, getmaxy(contentWin) - 4, 34, "N: Next text");
+        }
+    }
+    mvwprintw(contentWin, getmaxy(contentWin) - 3, 2, "Enter: Return to main menu");
 
-                for (size_t i = 0; i < textLines.size(); i++)
+    updateStatusWindowWithHelp("Session complete", context.endless ? "Press Enter to continue" : "R: Retry  G: Race best  Enter: Continue");
+    wrefresh(contentWin);
+}
+
+// 显示结果界面，返回用户选择的下一步
+PracticeNext showPracticeResults(PracticeContext &context, const PracticeResults &results, bool canChangeText)
+{
+    drawPracticeResults(context, results, canChangeText);
+
+    while (true)
+    {
+        int ch = getch();
+        if (ch == KEY_RESIZE)
+        {
+            resizeWindows();
+            drawPracticeResults(context, results, canChangeText);
+        }
+        else if ((ch == 'r' || ch == 'R') && !context.endless)
+        {
+            return PRACTICE_RETRY;
+        }
+        else if ((ch == 'n' || ch == 'N') && !context.endless && canChangeText)
+        {
+            return PRACTICE_NEXT_TEXT;
+        }
+        else if ((ch == 'g' || ch == 'G') && !context.endless)
+        {
+            // 自适应文本可能已改变了练习文本，按实际输入的文本查找
+            if (replayManager->findBestReplay(context.session.getTextUtf8(), context.nextGhost))
+            {
+                return PRACTICE_RACE;
+            }
+        }
+        else if (ch == KEY_RETURN || ch == '\r' || ch == KEY_ESC)
+        {
+            return PRACTICE_EXIT;
+        }
+    }
+}
+
+// 进行一轮练习并显示结果，返回用户在结果界面选择的下一步
+// canChangeText表示练习文本来自语料库，可以换下一段
+PracticeNext runPracticeRound(PracticeContext &context, const string &practiceText, const PracticeOptions &options, bool canChangeText)
+{
+    startPracticeRound(context, practiceText, options);
+
+    while (context.isRunning())
+    {
+        if (context.endless)
+        {
+            refillPracticeText(context);
+        }
+
+        if (context.session.isPaused())
+        {
+            waitForResume(context);
+            continue;
+        }
+
+        int keyCount = waitForPracticeKeys(context);
+        if (keyCount > 0)
+        {
+            handlePracticeKeys(context, keyCount);
+        }
+    }
+
+    curs_set(1);
+
+    if (context.exitRequested)
+    {
+        return PRACTICE_EXIT;
+    }
+
+    // 时间到后仍在输入的按键不能被结果界面当作菜单选择
+    if (context.timeUp)
+    {
+        flushinp();
+    }
+
+    PracticeResults results = recordPracticeResults(context, options);
+    return showPracticeResults(context, results, canChangeText);
+}
+
+// 打字练习会话控制器：重试、换下一段文本和挑战个人最佳都在同一个循环中进行，
+// 不再递归调用，会话对象和显示缓冲区在各轮之间复用
+void practiceSession(string practiceText, const PracticeOptions &options)
+{
+    DifficultyLevel difficulty = options.difficulty;
+    uint32_t corpusId = options.corpusId;
+    bool canChangeText = false;
+
+    if (practiceText.empty())
+    {
+        difficulty = showDifficultyMenu();
+
+        if (difficulty == CANCEL)
+        {
+            return;
+        }
+        else if (difficulty == CUSTOM)
+        {
+            practiceText = getCustomText();
+        }
+        else
+        {
+            practiceText = pickPracticeText(difficulty, &corpusId);
+            canChangeText = true;
+        }
+    }
+
+    if (practiceText.empty())
+    {
+        return;
+    }
+
+    PracticeContext context;
+    PracticeOptions roundOptions = options;
+    ReplayData ghostData;
+
+    while (!practiceText.empty())
+    {
+        roundOptions.difficulty = difficulty;
+        roundOptions.corpusId = corpusId;
+        PracticeNext next = runPracticeRound(context, practiceText, roundOptions, canChangeText);
+
+        // 之后的每一轮都是普通练习（重试和换文本只在非无尽模式下提供）
+        roundOptions = PracticeOptions();
+        switch (next)
+        {
+        case PRACTICE_RETRY:
+            break;
+
+        case PRACTICE_NEXT_TEXT:
+            practiceText = pickPracticeText(difficulty, &corpusId);
+            break;
+
+        case PRACTICE_RACE:
+            // 上一轮的幽灵时间轴已在返回前用完，可以直接替换回放数据
+            swap(ghostData, context.nextGhost);
+            practiceText = ghostData.text;
+            roundOptions.ghost = &ghostData;
+            break;
+
+        case PRACTICE_EXIT:
+        default:
+            return;
+        }
+    }
+}
+
+// 多人比赛菜单，返回0取消、1主持比赛、2加入比赛
+int showRaceMenu()
+{
+    updateHeaderWindow("RACE");
+    clearContentWindow();
+
+    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+    mvwprintw(contentWin, 2, 2, "Race other users logged in to this machine:");
+    wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+
+    wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+    mvwprintw(contentWin, 4, 2, "1. Host a race - Choose the text and start when everyone has joined");
+    mvwprintw(contentWin, 5, 2, "2. Join a race - Join the race hosted on this machine");
+    mvwprintw(contentWin, 7, 2, "0. Return to main menu");
+    wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+
+    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+    mvwprintw(contentWin, 9, 2, "Socket: %s", RaceProtocol::DEFAULT_SOCKET_PATH);
+    wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
+
+    updateStatusWindowWithHelp("Select option (0-2):", "ESC to return");
+    wrefresh(contentWin);
+
+    while (true)
+    {
+        int ch = getch();
+
+        if (ch == KEY_RESIZE)
+        {
+            resizeWindows();
+            return showRaceMenu();
+        }
+
+        if (ch == KEY_ESC || ch == '0')
+        {
+            return 0;
+        }
+        else if (ch == '1' || ch == '2')
+        {
+            return ch - '0';
+        }
+    }
+}
+
+// 比赛名次：已完成的选手按用时排在前面，其余按已输入的字符数排序
+vector<const RacerInfo *> rankRacers(const vector<RacerInfo> &racers)
+{
+    vector<const RacerInfo *> ranking;
+    for (const RacerInfo &racer : racers)
+    {
+        ranking.push_back(&racer);
+    }
+
+    stable_sort(ranking.begin(), ranking.end(),
+                [](const RacerInfo *a, const RacerInfo *b)
                 {
-                    if (posInLine < textLines[i].length())
+                    bool aFinished = (a->progress.flags & RaceProtocol::PROGRESS_FINISHED) != 0;
+                    bool bFinished = (b->progress.flags & RaceProtocol::PROGRESS_FINISHED) != 0;
+                    if (aFinished != bFinished)
                     {
-                        posLine = i;
-                        break;
+                        return aFinished;
                     }
-                    posInLine -= textLines[i].length();
-                }
+                    if (aFinished)
+                    {
+                        return a->progress.elapsedMs < b->progress.elapsedMs;
+                    }
+                    return a->progress.position > b->progress.position;
+                });
+    return ranking;
+}
 
-                wmove(contentWin, 4 + posLine, 2 + posInLine);
-                wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
-                waddch(contentWin, practiceText[currentPos]);
-                wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+// 从firstRow开始绘制所有选手的进度条，自己的一行高亮；
+// 选手太多显示不下时只显示前几名，自己不在其中时显示在最后一行
+void drawRaceStandings(const RaceClient &client, int firstRow, size_t textLength)
+{
+    int maxY = getmaxy(contentWin);
+    int maxX = getmaxx(contentWin);
+    int rows = maxY - firstRow - 2;
+    vector<const RacerInfo *> ranking = rankRacers(client.getRacers());
+
+    size_t ownRank = ranking.size();
+    for (size_t i = 0; i < ranking.size(); i++)
+    {
+        if (ranking[i]->id == client.getRacerId())
+        {
+            ownRank = i;
+        }
+    }
+
+    string title = "Racers: " + to_string(ranking.size());
+    if (ownRank < ranking.size())
+    {
+        title += "   Your place: " + to_string(ownRank + 1);
+    }
+    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+    mvwprintw(contentWin, firstRow, 2, "%-*s", maxX - 4, title.c_str());
+    wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
 
-                userInput.pop_back();
-                currentPos--;
+    // 名次、名字、进度条、百分比、速度和状态
+    int barWidth = max(10, maxX - 50);
+    string bar;
+    for (int row = 0; row < rows; row++)
+    {
+        int y = firstRow + 1 + row;
+        size_t index = static_cast<size_t>(row);
+        if (row == rows - 1 && ownRank >= static_cast<size_t>(rows) && ownRank < ranking.size())
+        {
+            index = ownRank;
+        }
+        if (index >= ranking.size())
+        {
+            mvwprintw(contentWin, y, 2, "%*s", maxX - 4, "");
+            continue;
+        }
+
+        const RacerInfo &racer = *ranking[index];
+        const RaceProtocol::Progress &progress = racer.progress;
+        size_t position = min(static_cast<size_t>(progress.position), textLength);
+        size_t filled = textLength > 0 ? position * barWidth / textLength : 0;
+        bar.assign(filled, '#');
+        bar.append(barWidth - filled, '-');
+
+        char status[32] = "";
+        if (progress.flags & RaceProtocol::PROGRESS_FINISHED)
+        {
+            snprintf(status, sizeof(status), "%.1fs", progress.elapsedMs / 1000.0);
+        }
+        else if (!racer.connected)
+        {
+            snprintf(status, sizeof(status), "left");
+        }
+
+        int color = (racer.id == client.getRacerId()) ? COLOR_CURRENT : COLOR_DEFAULT;
+        wattron(contentWin, COLOR_PAIR(color));
+        mvwprintw(contentWin, y, 2, "%3zu. %-12.12s [%s] %3d%% %5.1f WPM %-8s", index + 1, racer.name.c_str(), bar.c_str(),
+                  textLength > 0 ? static_cast<int>(position * 100 / textLength) : 0, progress.wpmTenths / 10.0, status);
+        wattroff(contentWin, COLOR_PAIR(color));
+    }
+}
 
-                posLine = 0;
-                posInLine = currentPos;
-                for (size_t i = 0; i < textLines.size(); i++)
+// 进行一场多人比赛：在大厅等待主机开始，倒计时后比赛，完成后继续显示名次直到离开。
+// server不为空表示本机是主机，离开时比赛对所有选手结束
+// difficulty和corpusId为主机选择的文本（写入练习历史），加入别人的比赛时不知道文本来源
+void runRace(RaceClient &client, RaceServer *server, DifficultyLevel difficulty, uint32_t corpusId)
+{
+    const int COUNTDOWN_MS = 3000;
+
+    // 大厅：名单变化时重绘
+    bool redraw = true;
+    while (!client.isCountdownStarted())
+    {
+        if (redraw)
+        {
+            updateHeaderWindow(server != nullptr ? "RACE - HOSTING" : "RACE - LOBBY");
+            clearContentWindow();
+
+            wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+            mvwprintw(contentWin, 2, 2, server != nullptr ? "Waiting for racers to join (Quick Start > Race > Join)"
+                                                          : "Waiting for the host to start the race...");
+            wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+
+            const vector<RacerInfo> &racers = client.getRacers();
+            wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+            if (client.hasText())
+            {
+                mvwprintw(contentWin, 3, 2, "Text: %zu characters", Utf8::decode(client.getText()).size());
+            }
+            mvwprintw(contentWin, 5, 2, "Racers (%zu):", racers.size());
+
+            int maxRows = getmaxy(contentWin) - 8;
+            for (size_t i = 0; i < racers.size(); i++)
+            {
+                if (static_cast<int>(i) >= maxRows - 1 && racers.size() > static_cast<size_t>(maxRows))
                 {
-                    if (posInLine < textLines[i].length())
-                    {
-                        posLine = i;
-                        break;
-                    }
-                    posInLine -= textLines[i].length();
+                    mvwprintw(contentWin, 6 + static_cast<int>(i), 4, "... and %zu more", racers.size() - i);
+                    break;
                 }
+                mvwprintw(contentWin, 6 + static_cast<int>(i), 4, "%s%s", racers[i].name.c_str(),
+                          racers[i].id == client.getRacerId() ? " (you)" : "");
+            }
+            wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
 
-                wmove(contentWin, 4 + posLine, 2 + posInLine);
-                wattron(contentWin, COLOR_PAIR(COLOR_CURRENT));
-                waddch(contentWin, practiceText[currentPos]);
-                wattroff(contentWin, COLOR_PAIR(COLOR_CURRENT));
+            updateStatusWindowWithHelp(server != nullptr ? "Press ENTER to start the race" : "Waiting for the host",
+                                       server != nullptr ? "ENTER: Start  ESC: Cancel race" : "ESC: Leave");
+            wrefresh(contentWin);
+            redraw = false;
+        }
 
-                int progress = (currentPos * 100) / practiceText.size();
-                updateStatusWindowWithHelp("Progress: " + to_string(progress) + "%", "ESC: Menu");
+        KeyEvent key;
+        int keyCount = readKeyBurst(&key, 1, 100);
+        redraw = client.poll();
 
-                wrefresh(contentWin);
-            }
+        if (!client.getRejectReason().empty())
+        {
+            showMessageDialog(client.getRejectReason(), DIALOG_ERROR, "Race");
+            return;
+        }
+        if (!client.isConnected())
+        {
+            showMessageDialog("Lost connection to the race host.", DIALOG_ERROR, "Race");
+            return;
+        }
+        if (keyCount > 0 && key.isKeyCode && key.key == KEY_RESIZE)
+        {
+            resizeWindows();
+            redraw = true;
+        }
+        if (keyCount == 0 || key.isKeyCode)
+        {
             continue;
         }
 
-        if (isprint(ch))
+        if (key.key == KEY_ESC)
+        {
+            if (showConfirmDialog(server != nullptr ? "Cancel the race for everyone?" : "Leave the race?", "Race"))
+            {
+                return;
+            }
+            redraw = true;
+        }
+        else if (server != nullptr && client.hasText() && (key.key == KEY_RETURN || key.key == '\r'))
+        {
+            server->startCountdown(COUNTDOWN_MS);
+        }
+    }
+
+    // 比赛界面：上方是文本，下方是所有选手的进度条
+    string raceText = client.getText();
+    bool skipSpace = settingsManager->getBoolSetting(SettingKeys::SKIP_SPACE, true);
+    bool ignoreCase = settingsManager->getBoolSetting(SettingKeys::IGNORE_CASE, false);
+    auto startTime = client.getStartTime();
+
+    TypingSession session;
+    session.start(raceText, skipSpace, ignoreCase, startTime);
+    size_t textLength = session.getText().size();
+
+    // 文本最多占6行，其余的行留给进度条；终端大小改变后重新分配
+    SessionView view(contentWin, 4, 2);
+    int standingsRow = 0;
+    auto layoutRace = [&]()
+    {
+        int textRows = max(3, min(6, (getmaxy(contentWin) - 5) / 2));
+        standingsRow = 4 + textRows + 1;
+        view.resize(session, getmaxx(contentWin) - 6, textRows);
+    };
+    layoutRace();
+
+    string heading = "Get ready...";
+    auto redrawRace = [&]()
+    {
+        updateHeaderWindow("RACE");
+        clearContentWindow();
+        wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+        mvwprintw(contentWin, 2, 2, "%s", heading.c_str());
+        wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+        view.drawAll(session);
+        session.clearDirty();
+        drawRaceStandings(client, standingsRow, textLength);
+        view.refresh();
+    };
+
+    auto setHeading = [&](const string &text)
+    {
+        heading = text;
+        wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+        mvwprintw(contentWin, 2, 2, "%-*s", getmaxx(contentWin) - 4, heading.c_str());
+        wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+    };
+
+    curs_set(0);
+    redrawRace();
+
+    // 倒计时：期间的按键不计入（ESC离开）
+    int shownSeconds = -1;
+    while (true)
+    {
+        auto now = steady_clock::now();
+        if (now >= startTime)
         {
-            char typedChar = static_cast<char>(ch);
+            break;
+        }
 
-            if (skipSpace && typedChar == ' ')
+        long long remainingMs = duration_cast<milliseconds>(startTime - now).count();
+        int seconds = static_cast<int>((remainingMs + 999) / 1000);
+        if (seconds != shownSeconds)
+        {
+            shownSeconds = seconds;
+            setHeading("Race starts in " + to_string(seconds) + "...");
+            updateStatusWindowWithHelp("Get ready", server != nullptr ? "ESC: Cancel race" : "ESC: Leave");
+            view.refresh();
+        }
+
+        KeyEvent key;
+        int keyCount = readKeyBurst(&key, 1, static_cast<int>(min(100LL, remainingMs % 1000 + 1)));
+        if (client.poll())
+        {
+            drawRaceStandings(client, standingsRow, textLength);
+            view.refresh();
+        }
+        if (!client.isConnected())
+        {
+            showMessageDialog("Lost connection to the race host.", DIALOG_ERROR, "Race");
+            curs_set(1);
+            return;
+        }
+        if (keyCount > 0 && key.isKeyCode && key.key == KEY_RESIZE)
+        {
+            resizeWindows();
+            layoutRace();
+            redrawRace();
+            shownSeconds = -1;
+        }
+        if (keyCount > 0 && !key.isKeyCode && key.key == KEY_ESC)
+        {
+            if (showConfirmDialog(server != nullptr ? "Cancel the race for everyone?" : "Leave the race?", "Race"))
             {
-                continue;
+                curs_set(1);
+                return;
             }
+            redrawRace();
+            shownSeconds = -1;
+        }
+    }
+    flushinp();
+    setHeading("Go! Type the following text:");
+
+    // 进度按约15次/秒发送（没有变化时不发送），状态栏和练习中一样每250ms刷新
+    const auto PROGRESS_INTERVAL = milliseconds(66);
+    const auto HUD_INTERVAL = milliseconds(250);
+    auto nextProgressTime = startTime;
+    auto nextHudTime = startTime;
+    bool progressChanged = true;
+    bool exitRequested = false;
+
+    auto makeProgress = [&](steady_clock::time_point time)
+    {
+        RaceProtocol::Progress progress;
+        double elapsed = duration_cast<milliseconds>(session.isFinished() ? session.activeTimeAtLastKey()
+                                                                          : session.activeTime(time)).count() / 1000.0;
+        progress.position = static_cast<uint32_t>(session.getPosition());
+        progress.wpmTenths = static_cast<uint16_t>(min(session.getScore().rawWPM(elapsed) * 10, 65535.0));
+        progress.errors = static_cast<uint16_t>(min(session.getScore().getErrorCount(), size_t(65535)));
+        progress.flags = session.isFinished() ? RaceProtocol::PROGRESS_FINISHED : 0;
+        progress.elapsedMs = static_cast<uint32_t>(elapsed * 1000);
+        return progress;
+    };
+
+    const int MAX_KEY_BURST = 256;
+    KeyEvent keyBurst[MAX_KEY_BURST];
+
+    view.refresh();
+
+    while (!session.isFinished() && !exitRequested)
+    {
+        auto now = steady_clock::now();
 
-            char displayChar = typedChar;
+        if (client.poll())
+        {
+            drawRaceStandings(client, standingsRow, textLength);
+            view.refresh();
+        }
+        if (!client.isConnected())
+        {
+            showMessageDialog("Lost connection to the race host.", DIALOG_ERROR, "Race");
+            curs_set(1);
+            return;
+        }
 
-            if (ignoreCase)
+        if (now >= nextProgressTime)
+        {
+            if (progressChanged)
             {
-                if (islower(practiceText[currentPos]) && isupper(typedChar))
-                {
-                    displayChar = tolower(typedChar);
-                }
-                else if (isupper(practiceText[currentPos]) && islower(typedChar))
-                {
-                    displayChar = toupper(typedChar);
-                }
+                client.sendProgress(makeProgress(now));
+                progressChanged = false;
             }
+            nextProgressTime = now + PROGRESS_INTERVAL;
+        }
+
+        if (now >= nextHudTime)
+        {
+            updateStatusWindowWithHelp(session.getLiveStats().formatStatusLine(now, static_cast<int>(session.getPosition() * 100 / textLength), session.getScore()),
+                                       server != nullptr ? "ESC: Cancel race" : "ESC: Leave");
+            nextHudTime = now + HUD_INTERVAL;
+        }
+
+        // 等待按键，最多等到下一次发送进度或刷新状态栏（也是检查其他选手进度的间隔）
+        auto nextTimer = min(nextProgressTime, nextHudTime);
+        int waitMs = static_cast<int>(duration_cast<milliseconds>(nextTimer - now).count()) + 1;
+        int keyCount = readKeyBurst(keyBurst, MAX_KEY_BURST, waitMs);
 
-            userInput += displayChar;
+        for (int k = 0; k < keyCount && !session.isFinished() && !exitRequested; k++)
+        {
+            int ch = keyBurst[k].key;
+            bool isKeyCode = keyBurst[k].isKeyCode;
 
-            bool correct = false;
-            if (ignoreCase)
-            {
-                correct = (tolower(typedChar) == tolower(practiceText[currentPos]));
-            }
-            else
+            if (isKeyCode && ch == KEY_RESIZE)
             {
-                correct = (typedChar == practiceText[currentPos]);
+                resizeWindows();
+                layoutRace();
+                redrawRace();
+                nextHudTime = steady_clock::now();
+                continue;
             }
 
-            if (!correct)
+            if (!isKeyCode && ch == KEY_ESC)
             {
-                sessionErrors[practiceText[currentPos]]++;
-                statsManager->updateErrorChar(practiceText[currentPos]);
-            }
-
-            int posLine = 0;
-            int posInLine = currentPos;
+                // 比赛不暂停，对话框打开期间计时继续
+                view.drawDirty(session);
+                view.refresh();
+                for (int r = keyCount - 1; r > k; r--)
+                {
+                    unreadKey(keyBurst[r]);
+                }
+                keyCount = k + 1;
 
-            for (size_t i = 0; i < textLines.size(); i++)
-            {
-                if (posInLine < textLines[i].length())
+                if (showConfirmDialog(server != nullptr ? "Cancel the race for everyone?" : "Leave the race?", "Race"))
                 {
-                    posLine = i;
-                    break;
+                    exitRequested = true;
+                }
+                else
+                {
+                    redrawRace();
                 }
-                posInLine -= textLines[i].length();
+                continue;
             }
 
-            wmove(contentWin, 4 + posLine, 2 + posInLine);
-            if (correct)
-            {
-                wattron(contentWin, COLOR_PAIR(COLOR_CORRECT));
-            }
-            else
+            if (isKeyCode ? (ch == KEY_BACKSPACE) : (ch == KEY_BACKSPACE_ALT || ch == 127))
             {
-                wattron(contentWin, COLOR_PAIR(COLOR_INCORRECT));
+                session.backspace(keyBurst[k].time);
+                progressChanged = true;
+                continue;
             }
-            waddch(contentWin, displayChar);
 
-            if (correct)
-            {
-                wattroff(contentWin, COLOR_PAIR(COLOR_CORRECT));
-            }
-            else
+            if (!isKeyCode && ch >= 0x20 && ch != 0x7F && !session.isAtEnd())
             {
-                wattroff(contentWin, COLOR_PAIR(COLOR_INCORRECT));
+                session.typeChar(static_cast<char32_t>(ch), keyBurst[k].time);
+                progressChanged = true;
             }
+        }
 
-            currentPos++;
+        view.drawDirty(session);
+        view.refresh();
+    }
 
-            posLine = 0;
-            posInLine = currentPos;
-            for (size_t i = 0; i < textLines.size(); i++)
-            {
-                if (posInLine < textLines[i].length())
-                {
-                    posLine = i;
-                    break;
-                }
-                posInLine -= textLines[i].length();
-            }
+    curs_set(1);
 
-            if (currentPos < practiceText.size())
-            {
-                wmove(contentWin, 4 + posLine, 2 + posInLine);
-                wattron(contentWin, COLOR_PAIR(COLOR_CURRENT));
-                waddch(contentWin, practiceText[currentPos]);
-                wattroff(contentWin, COLOR_PAIR(COLOR_CURRENT));
-            }
+    if (exitRequested)
+    {
+        return;
+    }
 
-            int progress = (currentPos * 100) / practiceText.size();
-            updateStatusWindowWithHelp("Progress: " + to_string(progress) + "%", "ESC: Menu");
+    // 完成：立即发送最终成绩，之后继续显示其他选手的进度
+    client.sendProgress(makeProgress(steady_clock::now()));
+
+    const TypingScore &score = session.getScore();
+    double timeTaken = duration_cast<milliseconds>(session.activeTimeAtLastKey()).count() / 1000.0;
+    double wpm = score.rawWPM(timeTaken);
+    statsManager->updateStatistics(timeTaken, score.getTypedCount(), static_cast<int>(score.getCorrectCount()), wpm, score.accuracy());
+
+    KeyStatsTable sessionKeys = session.getKeyStats();
+    statsManager->mergeKeyStats(sessionKeys);
+
+    SessionRecord record;
+    record.timestamp = static_cast<int64_t>(time(nullptr));
+    record.corpusId = corpusId;
+    record.durationMs = static_cast<uint32_t>(duration_cast<milliseconds>(session.activeTimeAtLastKey()).count());
+    record.charsTyped = static_cast<uint32_t>(score.getTypedCount());
+    record.correctChars = static_cast<uint32_t>(score.getCorrectCount());
+    record.rawWPM = static_cast<float>(wpm);
+    record.netWPM = static_cast<float>(score.netWPM(timeTaken));
+    record.accuracy = static_cast<float>(score.accuracy());
+    record.mode = PRACTICE_MODE_RACE;
+    record.difficulty = static_cast<uint8_t>(difficulty);
+    statsManager->recordSession(record);
+
+    char summary[128];
+    snprintf(summary, sizeof(summary), "Finished in %.1f s - %.1f WPM, %.1f%% accuracy", timeTaken, wpm, score.accuracy());
+    setHeading(summary);
+    updateStatusWindowWithHelp("Waiting for the other racers",
+                               server != nullptr ? "ENTER/ESC: End race for everyone" : "ENTER/ESC: Return to menu");
+    view.refresh();
+    flushinp();
 
-            wrefresh(contentWin);
+    while (true)
+    {
+        KeyEvent key;
+        int keyCount = readKeyBurst(&key, 1, 100);
+        if (client.poll())
+        {
+            drawRaceStandings(client, standingsRow, textLength);
+            view.refresh();
+        }
+        if (keyCount > 0 && key.isKeyCode && key.key == KEY_RESIZE)
+        {
+            resizeWindows();
+            layoutRace();
+            redrawRace();
+        }
+        if (keyCount > 0 && !key.isKeyCode && (key.key == KEY_ESC || key.key == KEY_RETURN || key.key == '\r'))
+        {
+            return;
         }
     }
+}
 
-    curs_set(1);
+// 多人比赛：主机在本机的Unix域套接字上等待其他用户加入，所有人（包括主机）作为选手连接
+void racePractice()
+{
+    if (!RaceServer::isSupported())
+    {
+        showMessageDialog("Race mode uses Unix domain sockets and is only available on Linux.", DIALOG_INFO, "Race");
+        return;
+    }
 
-    if (exitRequested)
+    int choice = showRaceMenu();
+    if (choice == 0)
     {
         return;
     }
 
-    auto endTime = high_resolution_clock::now();
-    double totalSeconds = duration_cast<milliseconds>(endTime - startTime).count() / 1000.0;
-    double timeTaken = totalSeconds;
+    RaceServer server;
+    string error;
+    DifficultyLevel difficulty = CUSTOM;
+    uint32_t corpusId = 0;
+    if (choice == 1)
+    {
+        difficulty = showDifficultyMenu();
+        if (difficulty == CANCEL)
+        {
+            return;
+        }
+
+        string raceText = (difficulty == CUSTOM) ? getCustomText() : pickPracticeText(difficulty, &corpusId);
+        if (raceText.empty())
+        {
+            return;
+        }
 
-    int correctChars = 0;
-    for (size_t i = 0; i < min(userInput.size(), practiceText.size()); ++i)
+        if (!server.start(RaceProtocol::DEFAULT_SOCKET_PATH, raceText, error))
+        {
+            showMessageDialog(error, DIALOG_ERROR, "Race");
+            return;
+        }
+    }
+
+    RaceClient client;
+    if (!client.connect(RaceProtocol::DEFAULT_SOCKET_PATH, userManager->getCurrentUser().username, error))
+    {
+        showMessageDialog(error, DIALOG_ERROR, "Race");
+        return;
+    }
+
+    runRace(client, choice == 1 ? &server : nullptr, difficulty, corpusId);
+
+    client.disconnect();
+    server.stop();
+}
+
+// 趋势图的分组方式
+enum TrendGrouping
+{
+    TREND_SESSIONS,  // 每次练习一个点
+    TREND_DAYS,      // 每天的平均值
+    TREND_WEEKS      // 每周的平均值
+};
+
+// 各分组方式可选的范围（最近多少次练习/天/周，0表示全部）
+const size_t TREND_SPANS[3][3] = {{100, 1000, 0}, {30, 90, 365}, {26, 52, 260}};
+const char *const TREND_UNITS[3] = {"sessions", "days", "weeks"};
+
+// 趋势图的数据：横轴为练习序号或天/周编号，纵轴为净速度和正确率
+struct TrendSeries
+{
+    vector<float> x;
+    vector<float> wpm;
+    vector<float> accuracy;
+    float xMin = 0.0f;
+    float xMax = 0.0f;
+    size_t sessions = 0;  // 范围内的练习次数
+};
+
+// 本地时间与UTC的时差（秒），按天分组时使用
+long localUtcOffset()
+{
+    time_t now = time(nullptr);
+    tm utc = *gmtime(&now);
+    utc.tm_isdst = -1;
+    return static_cast<long>(difftime(now, mktime(&utc)));
+}
+
+// 从练习历史中取出最近span次练习（或天/周）的数据
+// 记录通过索引按时间顺序访问，系统时间被调回导致文件中的记录无序时也能正确取范围和分组
+void buildTrendSeries(const HistoryIndex &historyIndex, TrendGrouping grouping, size_t span, TrendSeries &series)
+{
+    series = TrendSeries();
+    size_t total = historyIndex.size();
+
+    if (grouping == TREND_SESSIONS)
+    {
+        size_t count = (span == 0 || span > total) ? total : span;
+        size_t start = total - count;
+        series.x.reserve(count);
+        series.wpm.reserve(count);
+        series.accuracy.reserve(count);
+        for (size_t i = start; i < total; i++)
+        {
+            const SessionRecord &record = historyIndex.recordAt(i);
+            series.x.push_back(static_cast<float>(i));
+            series.wpm.push_back(record.netWPM);
+            series.accuracy.push_back(record.accuracy);
+        }
+        series.xMin = static_cast<float>(start);
+        series.xMax = static_cast<float>(total > 0 ? total - 1 : 0);
+        series.sessions = count;
+        return;
+    }
+
+    // 按本地日期分组；1970-01-01是星期四，加3天后按7天分组得到从星期一开始的周
+    long offset = localUtcOffset();
+    auto bucketOf = [&](int64_t timestamp)
     {
-        if (userInput[i] == practiceText[i])
+        int64_t day = (timestamp + offset) / 86400;
+        return grouping == TREND_DAYS ? day : (day + 3) / 7;
+    };
+    int64_t current = bucketOf(static_cast<int64_t>(time(nullptr)));
+    int64_t oldest = current - static_cast<int64_t>(span) + 1;
+    int64_t oldestDay = (grouping == TREND_DAYS) ? oldest : oldest * 7 - 3;
+    int64_t cutoff = oldestDay * 86400 - offset;
+
+    // 按时间顺序二分查找范围的起点
+    size_t begin = historyIndex.lowerBound(cutoff);
+
+    int64_t bucket = 0;
+    double wpmSum = 0.0;
+    double accuracySum = 0.0;
+    size_t bucketSessions = 0;
+    auto emit = [&]()
+    {
+        if (bucketSessions > 0)
+        {
+            series.x.push_back(static_cast<float>(bucket - oldest));
+            series.wpm.push_back(static_cast<float>(wpmSum / bucketSessions));
+            series.accuracy.push_back(static_cast<float>(accuracySum / bucketSessions));
+        }
+    };
+    for (size_t i = begin; i < total; i++)
+    {
+        const SessionRecord &record = historyIndex.recordAt(i);
+        int64_t recordBucket = bucketOf(record.timestamp);
+        if (recordBucket != bucket)
         {
-            correctChars++;
+            emit();
+            bucket = recordBucket;
+            wpmSum = 0.0;
+            accuracySum = 0.0;
+            bucketSessions = 0;
         }
+        wpmSum += record.netWPM;
+        accuracySum += record.accuracy;
+        bucketSessions++;
+        series.sessions++;
     }
+    emit();
 
-    double accuracy = (userInput.empty()) ? 0 : (correctChars * 100.0 / userInput.size());
-    double wpm = (timeTaken > 0) ? (userInput.size() / 5.0) / (timeTaken / 60.0) : 0;
+    series.xMin = 0.0f;
+    series.xMax = static_cast<float>(span - 1);
+}
 
-    statsManager->updateStatistics(timeTaken, userInput.size(), correctChars, wpm, accuracy);
+// 在(row, 2)处画一张盲文折线图，左侧标出纵轴的最大值和最小值；ceiling大于0时纵轴不超过该值
+void drawTrendChart(int row, int rows, int columns, const char *title, const TrendSeries &series,
+                    const vector<float> &values, float ceiling)
+{
+    // 降采样到图表的横向点数（每个字符2个点）
+    vector<uint32_t> selected;
+    TrendChart::downsampleLTTB(series.x.data(), values.data(), values.size(), static_cast<size_t>(columns) * 2, selected);
 
-    updateHeaderWindow("SESSION RESULTS");
-    clearContentWindow();
+    float yMin = 0.0f;
+    float yMax = 0.0f;
+    TrendChart::valueRange(values.data(), selected, yMin, yMax);
+    yMax = (ceiling > 0.0f && yMax > ceiling) ? ceiling : yMax;
+
+    vector<wchar_t> cells;
+    TrendChart::renderBraille(series.x.data(), values.data(), selected, series.xMin, series.xMax, yMin, yMax,
+                              columns, rows, cells);
+
+    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+    mvwprintw(contentWin, row, 2, "%s", title);
+    if (!values.empty())
+    {
+        wprintw(contentWin, "  (latest %.1f)", values.back());
+    }
+    wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
 
     wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
-    mvwprintw(contentWin, 2, 2, "Time taken: %.1f seconds", timeTaken);
-    mvwprintw(contentWin, 3, 2, "Characters typed: %zu", userInput.size());
-    mvwprintw(contentWin, 4, 2, "Correct characters: %d", correctChars);
-    mvwprintw(contentWin, 5, 2, "Accuracy: %.1f%%", accuracy);
-    mvwprintw(contentWin, 6, 2, "Typing speed: %.1f WPM", wpm);
+    mvwprintw(contentWin, row + 1, 2, "%6.1f", yMax);
+    mvwprintw(contentWin, row + rows, 2, "%6.1f", yMin);
+    wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
 
-    if (!sessionErrors.empty())
+    wattron(contentWin, COLOR_PAIR(COLOR_STATS));
+    for (int line = 0; line < rows; line++)
     {
-        mvwprintw(contentWin, 8, 2, "Most common errors:");
+        mvwaddnwstr(contentWin, row + 1 + line, 10, cells.data() + static_cast<size_t>(line) * columns, columns);
+    }
+    wattroff(contentWin, COLOR_PAIR(COLOR_STATS));
+}
 
-        vector<pair<char, int>> sortedErrors(sessionErrors.begin(), sessionErrors.end());
-        sort(sortedErrors.begin(), sortedErrors.end(),
-             [](const pair<char, int> &a, const pair<char, int> &b)
-             {
-                 return a.second > b.second;
-             });
+// 显示速度和正确率的趋势
+void showTrends()
+{
+    const HistoryIndex &historyIndex = statsManager->getHistoryIndex();
+    if (historyIndex.size() == 0)
+    {
+        showMessageDialog("No practice history recorded yet.", DIALOG_INFO, "Trends");
+        return;
+    }
 
-        int row = 9;
-        for (size_t i = 0; i < min(size_t(5), sortedErrors.size()); ++i)
+    TrendGrouping grouping = TREND_SESSIONS;
+    size_t spanChoice = 0;
+    TrendSeries series;
+    bool rebuild = true;
+
+    while (true)
+    {
+        size_t span = TREND_SPANS[grouping][spanChoice];
+        if (rebuild)
         {
-            mvwprintw(contentWin, row++, 2, "Character '%c': %d times",
-                      sortedErrors[i].first, sortedErrors[i].second);
+            buildTrendSeries(historyIndex, grouping, span, series);
+            rebuild = false;
         }
-    }
 
-    if (wpm > 0)
-    {
-        mvwprintw(contentWin, 15, 2, "Performance Analysis:");
+        updateHeaderWindow("TRENDS");
+        clearContentWindow();
 
-        string speedComment;
-        if (wpm < 20)
+        int maxy = getmaxy(contentWin);
+        int maxx = getmaxx(contentWin);
+        int columns = maxx - 12;
+        int rows = (maxy - 9) / 2;
+
+        char scope[96];
+        if (grouping == TREND_SESSIONS)
         {
-            speedComment = "Beginner level. Keep practicing!";
+            snprintf(scope, sizeof(scope), "Last %zu of %zu sessions", series.sessions, historyIndex.size());
         }
-        else if (wpm < 40)
+        else
         {
-            speedComment = "Developing skills. Good progress!";
+            snprintf(scope, sizeof(scope), "%zu sessions in the last %zu %s, averaged per %s", series.sessions, span,
+                     TREND_UNITS[grouping], grouping == TREND_DAYS ? "day" : "week");
         }
-        else if (wpm < 60)
+
+        if (columns < 10 || rows < 2)
         {
-            speedComment = "Intermediate level. Well done!";
+            wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+            mvwprintw(contentWin, 2, 2, "Window too small for charts.");
+            wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
         }
-        else if (wpm < 80)
+        else if (series.x.empty())
         {
-            speedComment = "Advanced level. Impressive!";
+            wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+            mvwprintw(contentWin, 2, 2, "No sessions in the last %zu %s.", span, TREND_UNITS[grouping]);
+            wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
         }
         else
         {
-            speedComment = "Expert level. Amazing speed!";
+            drawTrendChart(1, rows, columns, "Net WPM", series, series.wpm, 0.0f);
+            drawTrendChart(rows + 3, rows, columns, "Accuracy %", series, series.accuracy, 100.0f);
         }
 
-        string accuracyComment;
-        if (accuracy < 90)
+        wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+        mvwprintw(contentWin, maxy - 4, 2, "%s", scope);
+        mvwprintw(contentWin, maxy - 3, 2, "S/D/W: Sessions/Days/Weeks   +/-: Change range");
+        wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
+
+        updateStatusWindowWithHelp("Press ESC or Enter to return...", "S/D/W: Grouping  +/-: Range");
+        wrefresh(contentWin);
+
+        int ch = getch();
+        if (ch == KEY_RESIZE)
         {
-            accuracyComment = "Focus on accuracy over speed.";
+            resizeWindows();
         }
-        else if (accuracy < 95)
+        else if (ch == 's' || ch == 'S' || ch == 'd' || ch == 'D' || ch == 'w' || ch == 'W')
         {
-            accuracyComment = "Good accuracy. Keep refining.";
+            TrendGrouping next = (tolower(ch) == 's') ? TREND_SESSIONS : (tolower(ch) == 'd') ? TREND_DAYS : TREND_WEEKS;
+            rebuild = (next != grouping);
+            grouping = next;
+            spanChoice = rebuild ? 0 : spanChoice;
         }
-        else if (accuracy < 98)
+        else if (ch == '+' || ch == '=' || ch == KEY_RIGHT)
         {
-            accuracyComment = "Excellent accuracy!";
+            rebuild = spanChoice < 2;
+            spanChoice = rebuild ? spanChoice + 1 : spanChoice;
         }
-        else
+        else if (ch == '-' || ch == KEY_LEFT)
         {
-            accuracyComment = "Perfect! Maintain this precision.";
+            rebuild = spanChoice > 0;
+            spanChoice = rebuild ? spanChoice - 1 : spanChoice;
+        }
+        else if (ch == KEY_ESC || ch == KEY_RETURN || ch == '\r' || ch == '\n')
+        {
+            break;
         }
+    }
+}
 
-        mvwprintw(contentWin, 16, 4, "%s", speedComment.c_str());
-        mvwprintw(contentWin, 17, 4, "%s", accuracyComment.c_str());
+// 统计界面历史查询的时间范围（天数为0表示全部）
+struct HistoryRangeOption
+{
+    const char *label;
+    int days;
+};
+const HistoryRangeOption HISTORY_RANGES[] = {
+    {"last 7 days", 7}, {"last 30 days", 30}, {"last 90 days", 90}, {"last year", 365}, {"all time", 0}};
+
+// 统计界面历史查询的难度选项
+struct HistoryLevelOption
+{
+    const char *label;
+    int difficulty;
+};
+const HistoryLevelOption HISTORY_LEVELS[] = {
+    {"all levels", HISTORY_ANY}, {"Easy", EASY}, {"Medium", MEDIUM}, {"Hard", HARD},
+    {"Chinese", CHI}, {"Custom", CUSTOM}, {"Imported", IMPORTED}};
+
+const size_t HISTORY_MODE_COUNT = PRACTICE_MODE_RACE + 1;
+
+// 统计界面当前的查询条件（各项为选项下标，模式和语料的0表示全部），离开界面后保留
+struct HistoryFilter
+{
+    size_t range = 1;
+    size_t mode = 0;
+    size_t level = 0;
+    size_t corpus = 0;
+};
+HistoryFilter statisticsFilter;
+
+// 在统计界面的row行显示当前查询条件和结果
+void drawHistoryQuery(const HistoryIndex &historyIndex, int row)
+{
+    const vector<Corpus> &library = corpusManager->getCorpusLibrary();
+    if (statisticsFilter.corpus > library.size())
+    {
+        statisticsFilter.corpus = 0;
     }
 
-    wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+    HistoryQuery query;
+    const HistoryRangeOption &range = HISTORY_RANGES[statisticsFilter.range];
+    if (range.days > 0)
+    {
+        query.from = static_cast<int64_t>(time(nullptr)) - static_cast<int64_t>(range.days) * 86400;
+    }
+    if (statisticsFilter.mode > 0)
+    {
+        query.mode = static_cast<int>(statisticsFilter.mode - 1);
+    }
+    query.difficulty = HISTORY_LEVELS[statisticsFilter.level].difficulty;
+    string corpusLabel = "all texts";
+    if (statisticsFilter.corpus > 0)
+    {
+        const Corpus &corpus = library[statisticsFilter.corpus - 1];
+        query.corpusId = SessionHistory::corpusId(corpus.filename);
+        corpusLabel = corpus.name;
+    }
 
-    mvwprintw(contentWin, getmaxy(contentWin) - 4, 2, "R: Retry with same text");
-    mvwprintw(contentWin, getmaxy(contentWin) - 3, 2, "Enter: Return to main menu");
+    HistorySummary result = historyIndex.summarize(query);
 
-    updateStatusWindowWithHelp("Session complete", "Press R to retry or Enter to continue");
-    wrefresh(contentWin);
+    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+    mvwprintw(contentWin, row, 2, "Query (R/M/L/C): %s, %s, %s, %.24s", range.label,
+              statisticsFilter.mode > 0 ? practiceModeName(static_cast<uint8_t>(query.mode)) : "all modes",
+              HISTORY_LEVELS[statisticsFilter.level].label, corpusLabel.c_str());
+    wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
 
-    while (true)
+    wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+    if (result.sessions == 0)
     {
-        int ch = getch();
-        if (ch == 'r' || ch == 'R')
-        {
-            practiceSession(practiceText);
-            return;
-        }
-        else if (ch == KEY_RETURN || ch == '\r' || ch == KEY_ESC)
-        {
-            return;
-        }
+        mvwprintw(contentWin, row + 1, 4, "No matching sessions");
+    }
+    else
+    {
+        mvwprintw(contentWin, row + 1, 4, "%zu sessions, net WPM %.1f average, %.1f best, accuracy %.1f%%, %.1f minutes",
+                  result.sessions, result.averageNetWPM, result.bestNetWPM, result.averageAccuracy,
+                  result.totalSeconds / 60.0);
     }
+    wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
 }
 
 // 显示统计信息
 void showStatistics()
 {
-    updateHeaderWindow("STATISTICS");
-    clearContentWindow();
-
-    UserStats stats = statsManager->getStatistics();
-    if (!statsManager->isStatsLoaded() || stats.sessionsCompleted == 0)
+    const UserStats &stats = statsManager->getStatistics();
+    bool hasStats = statsManager->isStatsLoaded() && stats.sessionsCompleted > 0;
+
+    // 练习历史映射到内存后直接汇总，不需要解析；全部历史的汇总在进入界面时计算一次，
+    // 切换查询条件、调整窗口大小和从趋势图返回时直接复用
+    const HistoryIndex &historyIndex = statsManager->getHistoryIndex();
+    const SessionHistory &history = historyIndex.getHistory();
+    HistorySummary all;
+    HistorySummary recent;
+    if (hasStats && history.size() > 0)
     {
-        wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
-        mvwprintw(contentWin, 2, 2, "No statistics available yet.");
-        mvwprintw(contentWin, 3, 2, "Complete at least one practice session.");
-        wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+        const SessionRecord *last = history.records() + history.size();
+        all = SessionHistory::summarize(history.records(), last);
+        recent = SessionHistory::summarize(last - min(history.size(), size_t(10)), last);
     }
-    else
+
+    while (true)
     {
-        wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
-        mvwprintw(contentWin, 2, 2, "Sessions completed: %d", stats.sessionsCompleted);
-        mvwprintw(contentWin, 3, 2, "Total typing time: %.1f seconds", stats.totalTypingTime);
-        mvwprintw(contentWin, 4, 2, "Average typing speed: %.1f WPM",
-                  (stats.totalTypingTime > 0) ? (stats.totalCharsTyped / 5.0) / (stats.totalTypingTime / 60.0) : 0);
-        mvwprintw(contentWin, 5, 2, "Overall accuracy: %.1f%%",
-                  (stats.totalCharsTyped > 0) ? (stats.totalCorrectChars * 100.0 / stats.totalCharsTyped) : 0);
-        mvwprintw(contentWin, 6, 2, "Best WPM: %.1f", stats.bestWPM);
-        mvwprintw(contentWin, 7, 2, "Best accuracy: %.1f%%", stats.bestAccuracy);
-        wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
+        updateHeaderWindow("STATISTICS");
+        clearContentWindow();
 
-        if (!stats.errorChars.empty())
+        if (!hasStats)
+        {
+            wattron(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+            mvwprintw(contentWin, 2, 2, "No statistics available yet.");
+            mvwprintw(contentWin, 3, 2, "Complete at least one practice session.");
+            wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE) | A_BOLD);
+        }
+        else
         {
             wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
-            mvwprintw(contentWin, 9, 2, "Most common errors:");
+            mvwprintw(contentWin, 2, 2, "Sessions completed: %d", stats.sessionsCompleted);
+            mvwprintw(contentWin, 3, 2, "Total typing time: %.1f seconds", stats.totalTypingTime);
+            mvwprintw(contentWin, 4, 2, "Average typing speed: %.1f WPM",
+                      (stats.totalTypingTime > 0) ? (stats.totalCharsTyped / 5.0) / (stats.totalTypingTime / 60.0) : 0);
+            mvwprintw(contentWin, 5, 2, "Overall accuracy: %.1f%%",
+                      (stats.totalCharsTyped > 0) ? (stats.totalCorrectChars * 100.0 / stats.totalCharsTyped) : 0);
+            mvwprintw(contentWin, 6, 2, "Best WPM: %.1f", stats.bestWPM);
+            mvwprintw(contentWin, 7, 2, "Best accuracy: %.1f%%", stats.bestAccuracy);
+
+            if (history.size() > 0)
+            {
+                const SessionRecord *last = history.records() + history.size();
+
+                char since[16];
+                time_t firstTime = static_cast<time_t>(all.firstTimestamp);
+                strftime(since, sizeof(since), "%Y-%m-%d", localtime(&firstTime));
+                mvwprintw(contentWin, 8, 2, "History: %zu sessions since %s, net WPM %.1f average, %.1f last %zu",
+                          all.sessions, since, all.averageNetWPM, recent.averageNetWPM, recent.sessions);
+
+                // 最近几十次练习的净速度迷你图
+                size_t sparkCount = min(history.size(), static_cast<size_t>(max(getmaxx(contentWin) - 20, 0)));
+                sparkCount = min(sparkCount, size_t(40));
+                if (sparkCount > 1)
+                {
+                    vector<float> recentWPM;
+                    vector<uint32_t> indices;
+                    for (size_t i = 0; i < sparkCount; i++)
+                    {
+                        recentWPM.push_back((last - sparkCount + i)->netWPM);
+                        indices.push_back(static_cast<uint32_t>(i));
+                    }
+                    float low = 0.0f;
+                    float high = 0.0f;
+                    TrendChart::valueRange(recentWPM.data(), indices, low, high);
+                    vector<wchar_t> spark;
+                    TrendChart::renderSparkline(recentWPM.data(), recentWPM.size(), low, high, spark);
+                    mvwprintw(contentWin, 9, 2, "Recent net WPM: ");
+                    wattron(contentWin, COLOR_PAIR(COLOR_STATS));
+                    waddnwstr(contentWin, spark.data(), static_cast<int>(spark.size()));
+                    wattroff(contentWin, COLOR_PAIR(COLOR_STATS));
+                    wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+                }
+            }
             wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
 
-            vector<pair<char, int>> sortedErrors(stats.errorChars.begin(), stats.errorChars.end());
-            sort(sortedErrors.begin(), sortedErrors.end(),
-                 [](const pair<char, int> &a, const pair<char, int> &b)
-                 {
-                     return a.second > b.second;
-                 });
+            // 按时间、模式、难度和语料查询历史，由索引直接定位命中的记录
+            if (history.size() > 0)
+            {
+                drawHistoryQuery(historyIndex, 10);
+            }
 
-            wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
-            int row = 10;
-            for (size_t i = 0; i < min(size_t(5), sortedErrors.size()); ++i)
+            // 常错字符和双字母组合从定长表中直接选出前几名
+            RankedEntry topKeys[5];
+            size_t keyCount = stats.keyStats.topErrors(topKeys, 5);
+            if (keyCount > 0)
             {
-                mvwprintw(contentWin, row++, 2, "Character '%c': %d times",
-                          sortedErrors[i].first, sortedErrors[i].second);
+                wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+                mvwprintw(contentWin, 13, 2, "Most common errors:");
+                wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
+
+                wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+                int row = 14;
+                for (size_t i = 0; i < keyCount; ++i)
+                {
+                    unsigned char key = static_cast<unsigned char>(topKeys[i].index);
+                    mvwprintw(contentWin, row, 2, "Character '%c': %u times", key, topKeys[i].value);
+                    if (stats.keyStats.getLatencySamples(key) > 1)
+                    {
+                        wprintw(contentWin, " (%.0f +/- %.0f ms)", stats.keyStats.getMeanLatency(key),
+                                sqrt(stats.keyStats.getLatencyVariance(key)));
+                    }
+                    row++;
+                }
+                wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+            }
+
+            RankedEntry topBigrams[5];
+            size_t bigramCount = stats.errorBigrams.topErrors(topBigrams, 5);
+            if (bigramCount > 0)
+            {
+                int col = getmaxx(contentWin) / 2;
+                wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+                mvwprintw(contentWin, 13, col, "Most mistyped key pairs:");
+                wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
+
+                // 空格显示为'_'
+                wattron(contentWin, COLOR_PAIR(COLOR_DEFAULT));
+                for (size_t i = 0; i < bigramCount; ++i)
+                {
+                    unsigned char first = BigramMatrix::firstOf(topBigrams[i].index);
+                    unsigned char second = BigramMatrix::secondOf(topBigrams[i].index);
+                    mvwprintw(contentWin, 14 + static_cast<int>(i), col + 2, "%c%c  %u errors",
+                              first == ' ' ? '_' : first, second == ' ' ? '_' : second, topBigrams[i].value);
+                }
+                wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
             }
-            wattroff(contentWin, COLOR_PAIR(COLOR_DEFAULT));
         }
-    }
 
-    updateStatusWindow("Press any key to return to the main menu...");
-    wrefresh(contentWin);
-    getch();
+        wattron(contentWin, COLOR_PAIR(COLOR_GUIDE));
+        mvwprintw(contentWin, getmaxy(contentWin) - 3, 2, "P: Replay a recorded session   T: Speed and accuracy trends");
+        wattroff(contentWin, COLOR_PAIR(COLOR_GUIDE));
+
+        updateStatusWindowWithHelp("Press any key to return to the main menu...", "P: Replays  T: Trends  R/M/L/C: Query");
+        wrefresh(contentWin);
+
+        int ch = getch();
+        if (ch == KEY_RESIZE)
+        {
+            resizeWindows();
+            continue;
+        }
+        if (ch == 'p' || ch == 'P')
+        {
+            replayManager->showReplayBrowser(headerWin, contentWin, statusWin);
+            return;
+        }
+        if (ch == 't' || ch == 'T')
+        {
+            showTrends();
+            continue;
+        }
+
+        // 切换查询条件后重新显示，其他键返回主菜单
+        switch (ch)
+        {
+        case 'r':
+        case 'R':
+            statisticsFilter.range = (statisticsFilter.range + 1) % (sizeof(HISTORY_RANGES) / sizeof(HISTORY_RANGES[0]));
+            break;
+        case 'm':
+        case 'M':
+            statisticsFilter.mode = (statisticsFilter.mode + 1) % (HISTORY_MODE_COUNT + 1);
+            break;
+        case 'l':
+        case 'L':
+            statisticsFilter.level = (statisticsFilter.level + 1) % (sizeof(HISTORY_LEVELS) / sizeof(HISTORY_LEVELS[0]));
+            break;
+        case 'c':
+        case 'C':
+            statisticsFilter.corpus = (statisticsFilter.corpus + 1) % (corpusManager->getCorpusLibrary().size() + 1);
+            break;
+        default:
+            return;
+        }
+    }
 }
 
 // 程序结束清理，替换为调用GUIHelper版本
@@ -1072,6 +2825,9 @@ void updateStatusWindowWithHelp(const string &status, const string &help)
 // 程序主入口
 int main()
 {
+    // 使用环境中的locale，宽字符版curses据此解码输入和绘制非ASCII字符
+    setlocale(LC_ALL, "");
+
 #ifdef _WIN32
     HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
     DWORD dwMode = 0;
@@ -1079,6 +2835,7 @@ int main()
     dwMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
     SetConsoleMode(hOut, dwMode);
 
+    // 控制台改为UTF-8代码页，locale也相应改为UTF-8
     SetConsoleOutputCP(CP_UTF8);
     setlocale(LC_ALL, "zh_CN.UTF-8");
 #endif
@@ -1102,6 +2859,7 @@ int main()
 
     userManager = new UserManager(USER_DIR);
     statsManager = new StatisticsManager();
+    userManager->setStatisticsManager(statsManager);
     corpusManager = new CorpusManager(CORPUS_DIR);
 
 #ifdef _WIN32
@@ -1112,6 +2870,7 @@ int main()
 #endif
 
     settingsManager = new SettingsManager();
+    replayManager = new ReplayManager();
 
     if (!userManager->selectUser(headerWin, contentWin, statusWin))
     {
@@ -1120,20 +2879,22 @@ int main()
         delete statsManager;
         delete corpusManager;
         delete settingsManager;
+        delete replayManager;
         return 0;
     }
 
     string statsPath = userManager->getCurrentUserStatsPath();
     if (!statsPath.empty())
     {
-        statsManager->setStatsPath(statsPath);
-        statsManager->loadStatistics();
+        loadUserStatistics(statsPath);
     }
 
     string settingsPath = SETTINGS_DIR + "\\" + userManager->getCurrentUser().username + ".settings";
     settingsManager->setSettingsPath(settingsPath);
     settingsManager->loadSettings();
 
+    replayManager->setReplayDir(userManager->getReplayDir(userManager->getCurrentUser().username));
+
     showWelcomeScreen();
 
     bool running = true;
@@ -1154,7 +2915,11 @@ int main()
                 string fullText = corpusManager->readCorpusFile(selectedCorpus.filename);
                 int wordCount = corpusManager->getWordCountForDifficulty(selectedCorpus.difficulty);
                 string practiceSegment = corpusManager->extractPracticeSegment(fullText, wordCount);
-                practiceSession(practiceSegment);
+
+                PracticeOptions options;
+                options.difficulty = selectedCorpus.difficulty;
+                options.corpusId = SessionHistory::corpusId(selectedCorpus.filename);
+                practiceSession(practiceSegment, options);
             }
             break;
         }
@@ -1168,20 +2933,24 @@ int main()
             showSettingsMenu();
             break;
         case 6:
+            // 选择界面中可以重命名或删除用户（连同回放目录），先写完排队的回放
+            replayManager->flush();
             if (userManager->switchUser(headerWin, contentWin, statusWin))
             {
                 statsPath = userManager->getCurrentUserStatsPath();
                 statsManager->resetStatistics();
                 if (!statsPath.empty())
                 {
-                    statsManager->setStatsPath(statsPath);
-                    statsManager->loadStatistics();
+                    loadUserStatistics(statsPath);
                 }
 
                 settingsPath = SETTINGS_DIR + "\\" + userManager->getCurrentUser().username + ".settings";
                 settingsManager->setSettingsPath(settingsPath);
                 settingsManager->loadSettings();
             }
+
+            // 选择界面中可能重命名了当前用户，回放目录随用户名更新
+            replayManager->setReplayDir(userManager->getReplayDir(userManager->getCurrentUser().username));
             break;
         case 7:
             running = false;
@@ -1194,5 +2963,6 @@ int main()
     delete statsManager;
     delete corpusManager;
     delete settingsManager;
+    delete replayManager;
     return 0;
 }
@@ -11,13 +11,16 @@
 #include <chrono>
 #include <random>
 #include <cstdlib>
+#include <clocale>
 #include <ctime>
+#include <cmath>
 #include <thread>
 #include <iomanip>
 #include <sstream>
 #include <fstream>
 #include <curses.h>
 #include <map>
+#include <memory>
 #ifdef _WIN32
 #include <windows.h>
 #include <filesystem>
@@ -28,6 +31,16 @@
 #include "settings_manager.h"  // 添加新的设置管理器
 #include "gui_helper.h"
 #include "key_practice.h"      // 添加新的键盘练习头文件
+#include "typing_session.h"    // 练习会话状态
+#include "session_view.h"      // 练习文本显示
+#include "session_replay.h"    // 练习回放
+#include "text_stream.h"       // 无尽模式的文本来源
+#include "latency_histogram.h"  // 输入延迟统计
+#include "utf8_text.h"         // UTF-8文本处理
+#include "word_index.h"        // 自适应文本的单词索引
+#include "race_server.h"       // 多人比赛主机
+#include "race_client.h"       // 多人比赛选手端
+#include "trend_chart.h"       // 速度和正确率的趋势图
 
 
 using namespace std;
@@ -39,11 +52,22 @@ namespace fs = std::filesystem;
 // 使用GUI模块中定义的常量和枚举
 typedef GUIHelper::DialogType DialogType;
 
+// 练习选项
+struct PracticeOptions
+{
+    TextStreamProducer *textStream = nullptr; // 无尽模式的文本来源，为空表示普通练习
+    int timeLimitSeconds = 0;                 // 限时测试的时长（秒），0表示不限时
+    const ReplayData *ghost = nullptr;        // 作为幽灵对手同时回放的个人最佳记录
+    DifficultyLevel difficulty = CUSTOM;      // 文本难度（写入练习历史）
+    uint32_t corpusId = 0;                    // 文本来自的语料（SessionHistory::corpusId），0表示自定义或混合文本
+};
+
 // 全局管理器
 extern UserManager *userManager;
 extern StatisticsManager *statsManager;
 extern CorpusManager *corpusManager;
 extern SettingsManager *settingsManager;  // 添加设置管理器
+extern ReplayManager *replayManager;      // 练习回放管理器
 
 // 全局常量
 extern const string CORPUS_DIR;
@@ -61,15 +85,19 @@ void updateHeaderWindow(const string &title);
 void updateStatusWindow(const string &status);
 void updateStatusWindowWithHelp(const string &status, const string &help);
 void clearContentWindow();
+void resizeWindows();
 bool showConfirmDialog(const string &message, const string &title);
 void showMessageDialog(const string &message, DialogType type, const string &title);
 void showWelcomeScreen();
 int showMainMenu(bool showUserOption = true);
 DifficultyLevel showDifficultyMenu();
-void practiceSession(string practiceText = "");
+void practiceSession(string practiceText = "", const PracticeOptions &options = PracticeOptions());
+void racePractice();
 string getCustomText();
 string generatePracticeText(int wordCount);
 void showStatistics();
+void showTrends();
+void loadUserStatistics(const string &statsPath);
 void updateStatistics(double timeTaken, int charsTyped, int correctChars, double wpm, double accuracy);
 void showSettingsMenu();  // 添加显示设置菜单的函数
 void cleanup();
@@ -0,0 +1,345 @@
+#include "typing_analysis.h"
+#include "utf8_text.h"
+#include <algorithm>
+#include <string_view>
+
+using namespace std;
+using namespace std::chrono;
+
+// 构造函数：双字母组合表只在这里分配一次
+TypingAnalysis::TypingAnalysis()
+    : bigramCount(BIGRAM_TABLE_SIZE, 0),
+      bigramErrors(BIGRAM_TABLE_SIZE, 0),
+      bigramLatencyNs(BIGRAM_TABLE_SIZE, 0)
+{
+    fill(charCount, charCount + 256, 0u);
+    fill(charErrors, charErrors + 256, 0u);
+}
+
+// 开始新的统计
+void TypingAnalysis::begin()
+{
+    fill(bigramCount.begin(), bigramCount.end(), 0);
+    fill(bigramErrors.begin(), bigramErrors.end(), 0);
+    fill(bigramLatencyNs.begin(), bigramLatencyNs.end(), 0);
+    fill(charCount, charCount + 256, 0u);
+    fill(charErrors, charErrors + 256, 0u);
+
+    words.clear();
+    wordText.clear();
+
+    hasPrevious = false;
+    hasKeyTime = false;
+    inWord = false;
+    completedUpTo = 0;
+}
+
+// 记录一次字符输入
+void TypingAnalysis::recordChar(size_t absPos, char32_t expected, bool correct, TimePoint time)
+{
+    char32_t current = expected;
+
+    if (current < 256)
+    {
+        charCount[current]++;
+        if (!correct)
+        {
+            charErrors[current]++;
+        }
+    }
+
+    // 只有连续位置上的两次输入才构成双字母转换（跳过的空格和退格都会打断）
+    // 双字母表按字节对索引，超出U+00FF的字符不计入
+    if (hasPrevious && absPos == previousPos + 1 && previousChar < 256 && current < 256)
+    {
+        size_t index = (static_cast<size_t>(previousChar) << 8) | current;
+        bigramCount[index]++;
+        bigramLatencyNs[index] += duration_cast<nanoseconds>(time - previousTime).count();
+        if (!correct)
+        {
+            bigramErrors[index]++;
+        }
+    }
+
+    if (expected != U' ')
+    {
+        if (!inWord && absPos >= completedUpTo)
+        {
+            // 单词用时从上一次按键算起，包含从上一个单词过渡过来的时间
+            inWord = true;
+            wordStartPos = absPos;
+            wordErrors = 0;
+            wordStartTime = hasKeyTime ? previousTime : time;
+        }
+
+        if (inWord && !correct)
+        {
+            wordErrors++;
+        }
+    }
+
+    hasPrevious = true;
+    hasKeyTime = true;
+    previousPos = absPos;
+    previousChar = current;
+    previousTime = time;
+}
+
+// 记录一次退格
+void TypingAnalysis::recordBackspace(TimePoint time)
+{
+    hasPrevious = false;
+    hasKeyTime = true;
+    previousTime = time;
+}
+
+// 扣除暂停时间
+void TypingAnalysis::excludeTime(steady_clock::duration paused)
+{
+    previousTime += paused;
+    wordStartTime += paused;
+}
+
+// 当前单词已输入完成
+void TypingAnalysis::completeWord(const char32_t* word, size_t length, TimePoint time)
+{
+    if (!inWord || length == 0)
+    {
+        return;
+    }
+
+    WordRecord record;
+    record.textOffset = static_cast<uint32_t>(wordText.size());
+    for (size_t i = 0; i < length; i++)
+    {
+        Utf8::append(wordText, word[i]);
+    }
+    record.textBytes = static_cast<uint32_t>(wordText.size() - record.textOffset);
+    record.length = static_cast<uint32_t>(length);
+    record.errors = wordErrors;
+    record.durationNs = duration_cast<nanoseconds>(time - wordStartTime).count();
+    words.push_back(record);
+
+    inWord = false;
+    completedUpTo = previousPos + 1;
+}
+
+// 压缩单词记录
+void TypingAnalysis::compact()
+{
+    if (words.size() < WORD_LIMIT)
+    {
+        return;
+    }
+
+    // 有错误的单词按文本排序后合并相同的单词
+    string_view allText(wordText);
+    auto textOf = [&](const WordRecord& record)
+    {
+        return allText.substr(record.textOffset, record.textBytes);
+    };
+
+    vector<uint32_t> order;
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        if (words[i].errors > 0)
+        {
+            order.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    stable_sort(order.begin(), order.end(),
+                [&](uint32_t a, uint32_t b)
+                {
+                    return textOf(words[a]) < textOf(words[b]);
+                });
+
+    vector<WordRecord> kept;
+    for (uint32_t index : order)
+    {
+        const WordRecord& record = words[index];
+        if (!kept.empty() && textOf(kept.back()) == textOf(record))
+        {
+            kept.back().length += record.length;
+            kept.back().errors += record.errors;
+            kept.back().durationNs += record.durationNs;
+        }
+        else
+        {
+            kept.push_back(record);
+        }
+    }
+
+    if (kept.size() > KEPT_ERROR_WORDS)
+    {
+        partial_sort(kept.begin(), kept.begin() + KEPT_ERROR_WORDS, kept.end(),
+                     [](const WordRecord& a, const WordRecord& b)
+                     {
+                         return a.errors > b.errors;
+                     });
+        kept.resize(KEPT_ERROR_WORDS);
+    }
+
+    // 没有错误的单词只保留最慢的几个
+    order.clear();
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        if (words[i].errors == 0)
+        {
+            order.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    size_t slowCount = min(order.size(), static_cast<size_t>(KEPT_SLOW_WORDS));
+    partial_sort(order.begin(), order.begin() + slowCount, order.end(),
+                 [this](uint32_t a, uint32_t b)
+                 {
+                     return words[a].durationNs * words[b].length > words[b].durationNs * words[a].length;
+                 });
+    for (size_t i = 0; i < slowCount; i++)
+    {
+        kept.push_back(words[order[i]]);
+    }
+
+    // 重新排列单词文本，复用原有的缓冲区
+    string text;
+    for (WordRecord& record : kept)
+    {
+        string_view word = textOf(record);
+        record.textOffset = static_cast<uint32_t>(text.size());
+        text.append(word.data(), word.size());
+    }
+    wordText.assign(text);
+    words.assign(kept.begin(), kept.end());
+}
+
+// 获取第index个完成的单词
+WordStat TypingAnalysis::getWord(size_t index) const
+{
+    const WordRecord& record = words[index];
+
+    WordStat stat;
+    stat.word = wordText.substr(record.textOffset, record.textBytes);
+    stat.errors = static_cast<int>(record.errors);
+    stat.seconds = record.durationNs / 1e9;
+    stat.msPerChar = record.durationNs / 1e6 / record.length;
+    return stat;
+}
+
+// 平均每字符用时最长的单词
+vector<WordStat> TypingAnalysis::slowestWords(size_t maxCount) const
+{
+    vector<uint32_t> order(words.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = static_cast<uint32_t>(i);
+    }
+
+    size_t count = min(maxCount, order.size());
+    partial_sort(order.begin(), order.begin() + count, order.end(),
+                 [this](uint32_t a, uint32_t b)
+                 {
+                     // 交叉相乘比较 duration/length，避免除法
+                     return words[a].durationNs * words[b].length > words[b].durationNs * words[a].length;
+                 });
+
+    vector<WordStat> result;
+    for (size_t i = 0; i < count; i++)
+    {
+        result.push_back(getWord(order[i]));
+    }
+    return result;
+}
+
+// 错误最多的单词（只包含有错误的单词）
+vector<WordStat> TypingAnalysis::errorProneWords(size_t maxCount) const
+{
+    vector<uint32_t> order;
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        if (words[i].errors > 0)
+        {
+            order.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    size_t count = min(maxCount, order.size());
+    partial_sort(order.begin(), order.begin() + count, order.end(),
+                 [this](uint32_t a, uint32_t b)
+                 {
+                     return words[a].errors > words[b].errors;
+                 });
+
+    vector<WordStat> result;
+    for (size_t i = 0; i < count; i++)
+    {
+        result.push_back(getWord(order[i]));
+    }
+    return result;
+}
+
+// 获取一个双字母组合的统计
+BigramStat TypingAnalysis::getBigram(unsigned char first, unsigned char second) const
+{
+    size_t index = (static_cast<size_t>(first) << 8) | second;
+
+    BigramStat stat;
+    stat.first = first;
+    stat.second = second;
+    stat.count = bigramCount[index];
+    stat.errors = bigramErrors[index];
+    stat.avgLatencyMs = stat.count > 0 ? bigramLatencyNs[index] / 1e6 / stat.count : 0.0;
+    return stat;
+}
+
+// 平均转换延迟最长的双字母组合（至少出现minCount次）
+vector<BigramStat> TypingAnalysis::slowestBigrams(size_t maxCount, uint32_t minCount) const
+{
+    vector<uint32_t> candidates;
+    for (size_t i = 0; i < BIGRAM_TABLE_SIZE; i++)
+    {
+        if (bigramCount[i] >= minCount && bigramCount[i] > 0)
+        {
+            candidates.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    size_t count = min(maxCount, candidates.size());
+    partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                 [this](uint32_t a, uint32_t b)
+                 {
+                     return bigramLatencyNs[a] * bigramCount[b] > bigramLatencyNs[b] * bigramCount[a];
+                 });
+
+    vector<BigramStat> result;
+    for (size_t i = 0; i < count; i++)
+    {
+        result.push_back(getBigram(candidates[i] >> 8, candidates[i] & 0xFF));
+    }
+    return result;
+}
+
+// 错误最多的双字母组合
+vector<BigramStat> TypingAnalysis::errorProneBigrams(size_t maxCount) const
+{
+    vector<uint32_t> candidates;
+    for (size_t i = 0; i < BIGRAM_TABLE_SIZE; i++)
+    {
+        if (bigramErrors[i] > 0)
+        {
+            candidates.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    size_t count = min(maxCount, candidates.size());
+    partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                 [this](uint32_t a, uint32_t b)
+                 {
+                     return bigramErrors[a] > bigramErrors[b];
+                 });
+
+    vector<BigramStat> result;
+    for (size_t i = 0; i < count; i++)
+    {
+        result.push_back(getBigram(candidates[i] >> 8, candidates[i] & 0xFF));
+    }
+    return result;
+}
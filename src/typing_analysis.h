@@ -0,0 +1,116 @@
+#ifndef TYPING_ANALYSIS_H
+#define TYPING_ANALYSIS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 单词统计结果
+struct WordStat
+{
+    std::string word;
+    int errors = 0;          // 输入该单词时的错误按键数
+    double seconds = 0.0;    // 完成该单词的用时
+    double msPerChar = 0.0;  // 平均每个字符的用时（毫秒）
+};
+
+// 双字母组合统计结果（只统计两个字符都在U+0000~U+00FF范围内的组合）
+struct BigramStat
+{
+    char32_t first = 0;
+    char32_t second = 0;
+    uint32_t count = 0;        // 计时的转换次数
+    uint32_t errors = 0;       // 第二个字符输入错误的次数
+    double avgLatencyMs = 0.0; // 平均转换延迟（毫秒）
+};
+
+// 单词和双字母组合级别的错误与延迟统计
+// 双字母组合按字节对(first << 8 | second)索引到固定大小的扁平数组中，每次按键只做数组加法；
+// 单词记录按完成顺序追加，单词文本连续存放在同一个缓冲区中，记录数超过WORD_LIMIT后可以用compact压缩
+class TypingAnalysis
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    static const size_t BIGRAM_TABLE_SIZE = 256 * 256;
+
+    // 压缩单词记录的阈值，以及压缩后保留的错误单词数和最慢单词数
+    static const size_t WORD_LIMIT = 1024;
+    static const size_t KEPT_ERROR_WORDS = 256;
+    static const size_t KEPT_SLOW_WORDS = 32;
+
+    TypingAnalysis();
+
+    // 开始新的统计
+    void begin();
+
+    // 记录一次字符输入；absPos为该字符在练习文本中的绝对位置
+    void recordChar(size_t absPos, char32_t expected, bool correct, TimePoint time);
+
+    // 记录一次退格（退格前后的两次按键不构成双字母转换）
+    void recordBackspace(TimePoint time);
+
+    // 扣除一段暂停时间（暂停前后的按键间隔和正在输入的单词用时不包括暂停）
+    void excludeTime(std::chrono::steady_clock::duration paused);
+
+    // 刚输入的字符是当前单词的最后一个字符，word为该单词的文本
+    void completeWord(const char32_t* word, size_t length, TimePoint time);
+
+    // 单词记录达到WORD_LIMIT时压缩（无尽模式下丢弃已输入的文本时调用，保持内存恒定）：
+    // 有错误的单词按文本合并，只保留错误最多的KEPT_ERROR_WORDS个；没有错误的单词只保留最慢的KEPT_SLOW_WORDS个
+    void compact();
+
+    // 查询结果
+    size_t getWordCount() const { return words.size(); }
+    WordStat getWord(size_t index) const;
+    std::vector<WordStat> slowestWords(size_t maxCount) const;
+    std::vector<WordStat> errorProneWords(size_t maxCount) const;
+
+    // 单个字符（U+0000~U+00FF）的输入次数和错误次数
+    uint32_t getCharCount(unsigned char ch) const { return charCount[ch]; }
+    uint32_t getCharErrors(unsigned char ch) const { return charErrors[ch]; }
+
+    BigramStat getBigram(unsigned char first, unsigned char second) const;
+    std::vector<BigramStat> slowestBigrams(size_t maxCount, uint32_t minCount = 2) const;
+    std::vector<BigramStat> errorProneBigrams(size_t maxCount) const;
+
+private:
+    // 已完成的单词
+    struct WordRecord
+    {
+        uint32_t textOffset;  // 在wordText中的起始位置
+        uint32_t textBytes;   // UTF-8字节数
+        uint32_t length;      // 字符数（合并的记录为各次之和）
+        uint32_t errors;
+        int64_t durationNs;
+    };
+
+    // 双字母组合表（按字节对索引）
+    std::vector<uint32_t> bigramCount;
+    std::vector<uint32_t> bigramErrors;
+    std::vector<int64_t> bigramLatencyNs;
+
+    // 单字符表
+    uint32_t charCount[256];
+    uint32_t charErrors[256];
+
+    std::vector<WordRecord> words;
+    std::string wordText;
+
+    // 上一次字符输入，用于计算双字母转换延迟
+    bool hasPrevious = false;
+    size_t previousPos = 0;
+    char32_t previousChar = 0;
+    bool hasKeyTime = false;  // previousTime是否有效（退格也会更新）
+    TimePoint previousTime;
+
+    // 正在输入的单词
+    bool inWord = false;
+    size_t wordStartPos = 0;
+    uint32_t wordErrors = 0;
+    TimePoint wordStartTime;
+    size_t completedUpTo = 0;  // 已完成单词覆盖到的位置，退格后重新输入不会重复记录
+};
+
+#endif // TYPING_ANALYSIS_H
@@ -0,0 +1,75 @@
+#include "typing_score.h"
+
+// 清空所有计数
+void TypingScore::reset()
+{
+    typedChars = 0;
+    correctChars = 0;
+    keystrokes = 0;
+    mistakes = 0;
+    rejected = 0;
+}
+
+// 输入一个字符
+void TypingScore::recordChar(bool correct)
+{
+    typedChars++;
+    keystrokes++;
+    if (correct)
+    {
+        correctChars++;
+    }
+    else
+    {
+        mistakes++;
+    }
+}
+
+// 自动跳过的字符
+void TypingScore::recordSkipped()
+{
+    typedChars++;
+    correctChars++;
+}
+
+// 退格删除一个字符
+void TypingScore::removeChar(bool wasCorrect)
+{
+    if (typedChars == 0)
+    {
+        return;
+    }
+
+    typedChars--;
+    if (wasCorrect && correctChars > 0)
+    {
+        correctChars--;
+    }
+}
+
+// 被拒绝的按键
+void TypingScore::recordRejected()
+{
+    keystrokes++;
+    mistakes++;
+    rejected++;
+}
+
+// 准确率
+double TypingScore::accuracy() const
+{
+    size_t attempts = typedChars + rejected;
+    return (attempts > 0) ? (correctChars * 100.0 / attempts) : 0.0;
+}
+
+// 原始速度
+double TypingScore::rawWPM(double seconds) const
+{
+    return (seconds > 0) ? (typedChars / 5.0) / (seconds / 60.0) : 0.0;
+}
+
+// 净速度
+double TypingScore::netWPM(double seconds) const
+{
+    return (seconds > 0) ? (correctChars / 5.0) / (seconds / 60.0) : 0.0;
+}
@@ -0,0 +1,53 @@
+#ifndef TYPING_SCORE_H
+#define TYPING_SCORE_H
+
+#include <cstddef>
+
+// 练习成绩的增量计数
+// 每次输入、退格时更新计数，速度、准确率和错误数随时可以O(1)得到，
+// 文本练习和键位练习共用同一套计分规则
+class TypingScore
+{
+public:
+    // 清空所有计数
+    void reset();
+
+    // 输入一个字符
+    void recordChar(bool correct);
+
+    // 自动跳过的字符（如跳过空格模式下的空格），视为正确输入但不算按键
+    void recordSkipped();
+
+    // 退格删除一个已输入的字符
+    void removeChar(bool wasCorrect);
+
+    // 输错后被拒绝的按键（遇错即停模式下光标不前进），计为一次错误按键
+    void recordRejected();
+
+    // 当前保留的输入字符数和其中正确的字符数
+    size_t getTypedCount() const { return typedChars; }
+    size_t getCorrectCount() const { return correctChars; }
+
+    // 未改正的错误字符数
+    size_t getErrorCount() const { return typedChars - correctChars; }
+
+    // 字符按键总数和其中输错的次数（包括之后被退格改正的）
+    size_t getKeystrokeCount() const { return keystrokes; }
+    size_t getMistakeCount() const { return mistakes; }
+
+    // 准确率（百分比）：正确字符占已输入字符（含被拒绝的按键）的比例
+    double accuracy() const;
+
+    // 原始速度（所有已输入字符）和净速度（只计正确字符），单位WPM
+    double rawWPM(double seconds) const;
+    double netWPM(double seconds) const;
+
+private:
+    size_t typedChars = 0;
+    size_t correctChars = 0;
+    size_t keystrokes = 0;
+    size_t mistakes = 0;
+    size_t rejected = 0;
+};
+
+#endif // TYPING_SCORE_H
@@ -0,0 +1,345 @@
+#include "typing_session.h"
+#include "utf8_text.h"
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+// 构造函数
+TypingSession::TypingSession()
+    : errorCounts(ERROR_TABLE_SIZE, 0)
+{
+    start("", true, false, steady_clock::now());
+}
+
+// 开始新的练习
+void TypingSession::start(const string& practiceText, bool skip, bool ignore, TimePoint time)
+{
+    text.clear();
+    widths.clear();
+    decodeAndAppend(practiceText);
+    input.clear();
+    input.reserve(text.size());
+    position = 0;
+    skipSpace = skip;
+    ignoreCase = ignore;
+    startTime = time;
+    lastKeyTime = time;
+    fill(errorCounts.begin(), errorCounts.end(), 0);
+    discardedChars = 0;
+    paused = false;
+    pausedTotal = steady_clock::duration::zero();
+    pausedAtLastKey = pausedTotal;
+    rejected = false;
+    outstandingErrors = 0;
+    firstErrorPos = NO_ERROR_POSITION;
+    score.reset();
+
+    // 按文本长度预留足够空间（含退格和错误），练习中不再分配
+    keyLog.begin(time, text.size() * 2 + 256);
+    discardedKeys.clear();
+    liveStats.start(time);
+    analysis.begin();
+
+    markDirty(0, text.size());
+    advanceOverSpaces();
+}
+
+// 输入一个字符
+TypeResult TypingSession::typeChar(char32_t typedChar, TimePoint time)
+{
+    if (isAtEnd() || (skipSpace && typedChar == U' '))
+    {
+        return TYPE_IGNORED;
+    }
+
+    char32_t expectedChar = text[position];
+
+    bool correct = (typedChar == expectedChar);
+    if (!correct && ignoreCase)
+    {
+        correct = (Utf8::foldCase(typedChar) == Utf8::foldCase(expectedChar));
+    }
+
+    // 遇错即停：记录这次错误，光标不前进
+    if (!correct && strictMode == STRICT_STOP_ON_ERROR)
+    {
+        recordError(expectedChar);
+        score.recordRejected();
+        analysis.recordChar(discardedChars + position, expectedChar, false, time);
+        lastKeyTime = time;
+        pausedAtLastKey = pausedTotal;
+        rejected = true;
+        markDirty(position, position + 1);
+        keyLog.record(time, KEYSTROKE_CHAR, expectedChar, typedChar, false, discardedChars + position);
+        return TYPE_INCORRECT;
+    }
+    if (rejected)
+    {
+        rejected = false;
+        markDirty(position, position + 1);
+    }
+
+    // 忽略大小写时按原文的大小写显示，保证isCorrectAt可以直接比较
+    input += correct ? expectedChar : typedChar;
+
+    if (!correct)
+    {
+        recordError(expectedChar);
+        if (outstandingErrors++ == 0)
+        {
+            firstErrorPos = position;
+        }
+    }
+    score.recordChar(correct);
+
+    size_t oldPos = position;
+    analysis.recordChar(discardedChars + oldPos, expectedChar, correct, time);
+
+    // 单词的最后一个字符：下一个字符是空格或已到文本末尾
+    if (expectedChar != U' ' && (oldPos + 1 >= text.size() || text[oldPos + 1] == U' '))
+    {
+        size_t wordStart = text.rfind(U' ', oldPos);
+        wordStart = (wordStart == u32string::npos) ? 0 : wordStart + 1;
+        analysis.completeWord(text.data() + wordStart, oldPos + 1 - wordStart, time);
+    }
+
+    position++;
+    lastKeyTime = time;
+    pausedAtLastKey = pausedTotal;
+
+    advanceOverSpaces();
+    markDirty(oldPos, position + 1);
+
+    keyLog.record(time, KEYSTROKE_CHAR, expectedChar, typedChar, correct, discardedChars + position);
+    liveStats.recordKey(time);
+
+    return correct ? TYPE_CORRECT : TYPE_INCORRECT;
+}
+
+// 退格
+bool TypingSession::backspace(TimePoint time)
+{
+    if (position == 0 || input.empty())
+    {
+        return false;
+    }
+
+    size_t oldPos = position;
+    bool wasCorrect = isCorrectAt(position - 1);
+    score.removeChar(wasCorrect);
+
+    // 退格只能从末尾删除，删除第一个错误时它之后的错误都已被删除
+    if (!wasCorrect && outstandingErrors > 0 && --outstandingErrors == 0)
+    {
+        firstErrorPos = NO_ERROR_POSITION;
+    }
+    rejected = false;
+    input.pop_back();
+    position--;
+    lastKeyTime = time;
+    pausedAtLastKey = pausedTotal;
+    char32_t expectedChar = text[position];
+
+    // 跳过空格模式下，退回到空格上时会立即重新跳过
+    advanceOverSpaces();
+    markDirty(min(position, oldPos - 1), oldPos + 1);
+
+    analysis.recordBackspace(time);
+    keyLog.record(time, KEYSTROKE_BACKSPACE, expectedChar, U'\b', false, discardedChars + position);
+    return true;
+}
+
+// 暂停
+void TypingSession::pause(TimePoint time)
+{
+    if (paused)
+    {
+        return;
+    }
+
+    paused = true;
+    pauseStart = time;
+    keyLog.record(time, KEYSTROKE_PAUSE, 0, 0, false, discardedChars + position);
+}
+
+// 继续：暂停时长从实时统计和单词/双字母组合的计时中扣除
+steady_clock::duration TypingSession::resume(TimePoint time)
+{
+    if (!paused)
+    {
+        return steady_clock::duration::zero();
+    }
+
+    steady_clock::duration pausedFor = max(time - pauseStart, steady_clock::duration::zero());
+    paused = false;
+    pausedTotal += pausedFor;
+    liveStats.excludeTime(pausedFor);
+    analysis.excludeTime(pausedFor);
+    keyLog.record(time, KEYSTROKE_RESUME, 0, 0, false, discardedChars + position);
+    return pausedFor;
+}
+
+// 有效练习时间
+steady_clock::duration TypingSession::activeTime(TimePoint time) const
+{
+    steady_clock::duration active = time - startTime - pausedTotal;
+    if (paused && time > pauseStart)
+    {
+        active -= time - pauseStart;
+    }
+    return max(active, steady_clock::duration::zero());
+}
+
+// 在文本末尾追加内容
+void TypingSession::appendText(const string& more)
+{
+    size_t oldSize = text.size();
+    decodeAndAppend(more);
+    markDirty(oldSize, text.size());
+
+    // 光标原本停在文本末尾时，新文本可能以空格开头
+    advanceOverSpaces();
+}
+
+// 替换尚未输入的一段文本
+bool TypingSession::replaceText(size_t from, size_t to, const string& replacement)
+{
+    if (from <= position || from > to || to > text.size())
+    {
+        return false;
+    }
+
+    u32string decoded = Utf8::decode(replacement);
+    text.replace(from, to - from, decoded);
+
+    widths.erase(widths.begin() + from, widths.begin() + to);
+    widths.insert(widths.begin() + from, decoded.size(), 1);
+    for (size_t i = 0; i < decoded.size(); i++)
+    {
+        widths[from + i] = static_cast<uint8_t>(Utf8::displayWidth(decoded[i]));
+    }
+
+    markDirty(from, text.size());
+    return true;
+}
+
+// 丢弃已输入完成的前缀
+void TypingSession::discardPrefix(size_t count)
+{
+    count = min(count, position);
+    if (count == 0)
+    {
+        return;
+    }
+
+    // 被丢弃部分中的错误不再计入未改正的错误；只扫描被丢弃的部分和视口内已输入的部分
+    if (outstandingErrors > 0 && firstErrorPos < count)
+    {
+        for (size_t i = firstErrorPos; i < count; i++)
+        {
+            if (!isCorrectAt(i))
+            {
+                outstandingErrors--;
+            }
+        }
+
+        firstErrorPos = NO_ERROR_POSITION;
+        for (size_t i = count; outstandingErrors > 0 && i < position; i++)
+        {
+            if (!isCorrectAt(i))
+            {
+                firstErrorPos = i;
+                break;
+            }
+        }
+    }
+    if (firstErrorPos != NO_ERROR_POSITION)
+    {
+        firstErrorPos -= count;
+    }
+
+    text.erase(0, count);
+    input.erase(0, count);
+    widths.erase(widths.begin(), widths.begin() + count);
+    position -= count;
+    discardedChars += count;
+    clearDirty();
+
+    discardedKeys.addLog(keyLog);
+    keyLog.discardPrefix(keyLog.size());
+    analysis.compact();
+}
+
+// 本次练习每个键的统计
+KeyStatsTable TypingSession::getKeyStats() const
+{
+    KeyStatsTable stats = discardedKeys;
+    stats.addLog(keyLog);
+    return stats;
+}
+
+// 自动跳过空格
+void TypingSession::advanceOverSpaces()
+{
+    size_t oldPos = position;
+    while (skipSpace && position < text.size() && text[position] == U' ')
+    {
+        input += U' ';
+        score.recordSkipped();
+        position++;
+    }
+
+    if (position != oldPos)
+    {
+        markDirty(oldPos, position + 1);
+    }
+}
+
+// 解码并追加文本
+void TypingSession::decodeAndAppend(const string& utf8)
+{
+    // 直接解码到文本末尾，重新开始练习时复用已有的容量
+    size_t oldSize = text.size();
+    Utf8::decodeAppend(utf8, text);
+
+    widths.reserve(text.size());
+    for (size_t i = oldSize; i < text.size(); i++)
+    {
+        widths.push_back(static_cast<uint8_t>(Utf8::displayWidth(text[i])));
+    }
+}
+
+// 练习文本的UTF-8形式（保存回放时使用）
+string TypingSession::getTextUtf8() const
+{
+    return Utf8::encode(text);
+}
+
+// 标记需要重绘的位置区间
+void TypingSession::markDirty(size_t from, size_t to)
+{
+    to = min(to, text.size());
+    if (from >= to)
+    {
+        return;
+    }
+
+    if (dirtyBegin >= dirtyEnd)
+    {
+        dirtyBegin = from;
+        dirtyEnd = to;
+    }
+    else
+    {
+        dirtyBegin = min(dirtyBegin, from);
+        dirtyEnd = max(dirtyEnd, to);
+    }
+}
+
+// 清除重绘区间
+void TypingSession::clearDirty()
+{
+    dirtyBegin = 0;
+    dirtyEnd = 0;
+}
@@ -0,0 +1,200 @@
+#ifndef TYPING_SESSION_H
+#define TYPING_SESSION_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "key_stats.h"
+#include "keystroke_log.h"
+#include "live_stats.h"
+#include "typing_analysis.h"
+#include "typing_score.h"
+
+// 字符输入的处理结果
+enum TypeResult
+{
+    TYPE_IGNORED,   // 未被接受（如跳过空格模式下输入的空格）
+    TYPE_CORRECT,   // 输入正确
+    TYPE_INCORRECT  // 输入错误
+};
+
+// 严格模式
+enum StrictMode : uint8_t
+{
+    STRICT_OFF = 0,           // 输错后光标照常前进
+    STRICT_STOP_ON_ERROR = 1, // 输错时光标停留，直到按下正确的键
+    STRICT_MUST_CORRECT = 2   // 输错后可以继续，但所有错误都用退格改正后才能完成
+};
+
+// 打字练习会话的状态
+// 只维护练习状态（文本、输入、光标、逐键记录和实时统计），不涉及界面绘制，
+// 练习界面和回放查看器通过SessionView显示同一个会话。
+// 文本在开始时一次性从UTF-8解码为UTF-32码位并计算每个字符的显示宽度，
+// 练习中的位置、比较和绘制都以码位为单位，ASCII文本和中文、带重音的拉丁文走同一条路径
+class TypingSession
+{
+public:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+
+    TypingSession();
+
+    // 开始新的练习，text为UTF-8文本
+    void start(const std::string& text, bool skipSpace, bool ignoreCase, TimePoint startTime);
+
+    // 输入一个字符（Unicode码位）
+    TypeResult typeChar(char32_t typed, TimePoint time);
+
+    // 退格，返回是否删除了字符
+    bool backspace(TimePoint time);
+
+    // 暂停与继续：暂停期间的时间不计入成绩和统计，暂停和继续都写入逐键记录
+    void pause(TimePoint time);
+    std::chrono::steady_clock::duration resume(TimePoint time);  // 返回本次暂停的时长
+    bool isPaused() const { return paused; }
+
+    // 累计暂停时长（不含正在进行的暂停）
+    std::chrono::steady_clock::duration getPausedDuration() const { return pausedTotal; }
+
+    // 从练习开始到time的有效练习时间（扣除time之前的所有暂停，time不早于最近一次继续）
+    std::chrono::steady_clock::duration activeTime(TimePoint time) const;
+
+    // 从练习开始到最后一次按键的有效练习时间（之后的暂停不扣除）
+    std::chrono::steady_clock::duration activeTimeAtLastKey() const { return lastKeyTime - startTime - pausedAtLastKey; }
+
+    // 在文本末尾追加UTF-8内容（无尽模式）
+    void appendText(const std::string& more);
+
+    // 将尚未输入的区间 [from, to) 替换为UTF-8内容（from必须在当前位置之后），返回是否替换
+    bool replaceText(size_t from, size_t to, const std::string& replacement);
+
+    // 丢弃已输入完成的前count个字符，之后的位置整体前移（无尽模式下保持内存恒定）
+    // 逐键记录同时折算到按键统计中后清空，单词统计只保留对结果有用的部分
+    void discardPrefix(size_t count);
+
+    // 严格模式（在start之前或之后设置均可，start不会改变模式）
+    void setStrictMode(StrictMode mode) { strictMode = mode; }
+    StrictMode getStrictMode() const { return strictMode; }
+
+    // 是否已完成：输入到文本末尾，且必须改正模式下没有未改正的错误
+    bool isFinished() const
+    {
+        return position >= text.size() && (strictMode != STRICT_MUST_CORRECT || outstandingErrors == 0);
+    }
+
+    // 光标是否已到文本末尾（必须改正模式下可能还有错误未改正）
+    bool isAtEnd() const { return position >= text.size(); }
+
+    // 未改正的错误数和第一个错误的位置（没有错误时为NO_ERROR_POSITION），均为O(1)维护
+    static const size_t NO_ERROR_POSITION = static_cast<size_t>(-1);
+    size_t getOutstandingErrors() const { return outstandingErrors; }
+    size_t getFirstErrorPosition() const { return firstErrorPos; }
+
+    // 遇错即停模式下最后一次按键是否被拒绝（当前字符显示为错误颜色）
+    bool isRejected() const { return rejected; }
+
+    // 获取练习状态
+    const std::u32string& getText() const { return text; }
+    const std::u32string& getInput() const { return input; }
+    const std::vector<uint8_t>& getWidths() const { return widths; }  // 每个字符的显示宽度
+    std::string getTextUtf8() const;
+    size_t getPosition() const { return position; }
+    bool isSkipSpace() const { return skipSpace; }
+    bool isIgnoreCase() const { return ignoreCase; }
+
+    // 已输入位置是否正确
+    bool isCorrectAt(size_t pos) const { return input[pos] == text[pos]; }
+
+    // 已输入的字符数和其中正确的字符数（包括已丢弃的部分）
+    size_t getTypedCount() const { return score.getTypedCount(); }
+    size_t getCorrectCount() const { return score.getCorrectCount(); }
+
+    // 练习成绩（随输入和退格增量更新）
+    const TypingScore& getScore() const { return score; }
+
+    // 已丢弃的字符数（当前位置加上该值即为从练习开始算起的绝对位置）
+    size_t getDiscardedCount() const { return discardedChars; }
+
+    // 练习开始时间和最后一次按键时间
+    TimePoint getStartTime() const { return startTime; }
+    TimePoint getLastKeyTime() const { return lastKeyTime; }
+
+    // 逐键记录和实时统计（无尽模式下逐键记录只包含最近一次丢弃文本之后的按键）
+    const KeystrokeLog& getKeyLog() const { return keyLog; }
+    LiveStats& getLiveStats() { return liveStats; }
+
+    // 本次练习每个键的统计（已折算的按键加上逐键记录中的按键）
+    KeyStatsTable getKeyStats() const;
+
+    // 单词和双字母组合统计
+    const TypingAnalysis& getAnalysis() const { return analysis; }
+
+    // 本次练习的错误字符统计：按码位索引的定长数组，只统计基本多文种平面（U+0000~U+FFFF）内的字符
+    static const size_t ERROR_TABLE_SIZE = 0x10000;
+    uint32_t getErrorCount(char32_t ch) const { return ch < ERROR_TABLE_SIZE ? errorCounts[ch] : 0; }
+
+    // 错误最多的字符，RankedEntry::index为码位
+    size_t topErrors(RankedEntry* out, size_t maxCount) const
+    {
+        return selectTopK(errorCounts.data(), ERROR_TABLE_SIZE, out, maxCount);
+    }
+
+    // 需要重绘的位置区间 [dirtyBegin, dirtyEnd)
+    bool hasDirty() const { return dirtyBegin < dirtyEnd; }
+    size_t getDirtyBegin() const { return dirtyBegin; }
+    size_t getDirtyEnd() const { return dirtyEnd; }
+    void clearDirty();
+
+private:
+    // 自动跳过空格
+    void advanceOverSpaces();
+
+    // 记录一次错误（超出错误统计表范围的字符不计入）
+    void recordError(char32_t expected)
+    {
+        if (expected < ERROR_TABLE_SIZE)
+        {
+            errorCounts[expected]++;
+        }
+    }
+
+    // 解码并追加文本，同时计算显示宽度
+    void decodeAndAppend(const std::string& utf8);
+
+    // 标记需要重绘的位置区间
+    void markDirty(size_t from, size_t to);
+
+    std::u32string text;
+    std::u32string input;
+    std::vector<uint8_t> widths;
+    size_t position = 0;
+    bool skipSpace = true;
+    bool ignoreCase = false;
+
+    TimePoint startTime;
+    TimePoint lastKeyTime;
+
+    KeystrokeLog keyLog;
+    KeyStatsTable discardedKeys;  // 已从逐键记录中丢弃的按键的统计
+    LiveStats liveStats;
+    TypingAnalysis analysis;
+    TypingScore score;
+    std::vector<uint32_t> errorCounts;  // 构造时一次分配，练习中只做数组加法
+
+    size_t dirtyBegin = 0;
+    size_t dirtyEnd = 0;
+
+    size_t discardedChars = 0;    // 已丢弃的字符数
+
+    StrictMode strictMode = STRICT_OFF;
+    bool rejected = false;
+    size_t outstandingErrors = 0;  // 当前位置之前未改正的错误数
+    size_t firstErrorPos = NO_ERROR_POSITION;
+
+    bool paused = false;
+    TimePoint pauseStart;
+    std::chrono::steady_clock::duration pausedTotal{0};
+    std::chrono::steady_clock::duration pausedAtLastKey{0};  // 最后一次按键时的累计暂停时长
+};
+
+#endif // TYPING_SESSION_H
@@ -1,5 +1,7 @@
 #include "user_manager.h"
 #include "gui_helper.h" // 添加GUI辅助模块头文件
+#include "session_history.h"
+#include "statistics_manager.h"
 #include <filesystem>
 #include <fstream>
 #include <algorithm>
@@ -78,6 +80,25 @@ string UserManager::getCurrentUserStatsPath() const {
     return currentUser.statsFile;
 }
 
+// 等待统计和历史数据写完
+void UserManager::flushStatistics() {
+    if (statsManager != nullptr) {
+        statsManager->flush();
+    }
+}
+
+// 统计管理器改用新的统计文件路径
+void UserManager::retargetStatistics(const string& oldStatsFile, const string& newStatsFile) {
+    if (statsManager != nullptr && statsManager->getStatsPath() == oldStatsFile) {
+        statsManager->setStatsPath(newStatsFile);
+    }
+}
+
+// 用户的回放目录
+string UserManager::getReplayDir(const string& username) const {
+    return userDir + "\\" + username + "_replays";
+}
+
 // 用户选择界面
 bool UserManager::selectUser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin) {
     // 如果没有用户，引导创建新用户
@@ -145,6 +166,11 @@ bool UserManager::selectUser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* stat
         int ch = wgetch(contentWin); // 从contentWin获取输入
         
         switch (ch) {
+            case KEY_RESIZE:
+                // 终端大小改变，下一轮按新尺寸重绘
+                GUIHelper::resizeWindows(headerWin, contentWin, statusWin);
+                break;
+
             case KEY_UP:
                 if (selectedIndex > 0) {
                     selectedIndex--;
@@ -445,11 +471,28 @@ bool UserManager::renameUser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* stat
     string oldStatsFile = user.statsFile;
     string newStatsFile = userDir + "\\" + newName + ".dat";
     
+    // 先写完排队的数据，改名后统计管理器也改用新路径，之后的保存不会重新创建旧文件
+    flushStatistics();
+
     try {
         // 如果统计文件存在，重命名它
         if (fs::exists(oldStatsFile)) {
             fs::rename(oldStatsFile, newStatsFile);
         }
+
+        // 练习历史文件与统计文件同名，一起重命名
+        string oldHistoryFile = SessionHistory::pathForStats(oldStatsFile);
+        if (fs::exists(oldHistoryFile)) {
+            fs::rename(oldHistoryFile, SessionHistory::pathForStats(newStatsFile));
+        }
+
+        // 回放目录（包括幽灵对手使用的个人最佳记录）也随用户名重命名
+        string oldReplayDir = getReplayDir(user.username);
+        if (fs::exists(oldReplayDir)) {
+            fs::rename(oldReplayDir, getReplayDir(newName));
+        }
+
+        retargetStatistics(oldStatsFile, newStatsFile);
         
         // 更新用户列表
         for (auto& u : users) {
@@ -528,11 +571,16 @@ bool UserManager::deleteUser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* stat
     string userPath = userDir + "\\" + deletedUsername;
     string userStatsPath = userDir + "\\" + deletedUsername + ".dat"; // 修正为正确的文件路径
 
+    // 先写完排队的数据并让统计管理器不再写这个用户的文件，再删除
+    flushStatistics();
+    retargetStatistics(userStatsPath, "");
+
     // 尝试删除统计文件
     if (fs::exists(userStatsPath))
     {
         try {
             fs::remove(userStatsPath);
+            fs::remove(SessionHistory::pathForStats(userStatsPath));
         }
         catch (const fs::filesystem_error& e) {
             GUIHelper::showMessageDialog(headerWin, contentWin, statusWin,
@@ -542,11 +590,13 @@ bool UserManager::deleteUser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* stat
         }
     }
     
-    // 删除用户目录（如果存在）
-    if (fs::exists(userPath))
+    // 删除用户目录和回放目录（如果存在），同名的新用户不会继承旧的回放
+    string replayPath = getReplayDir(deletedUsername);
+    if (fs::exists(userPath) || fs::exists(replayPath))
     {
         try {
             fs::remove_all(userPath);
+            fs::remove_all(replayPath);
         }
         catch (const fs::filesystem_error& e) {
             GUIHelper::showMessageDialog(headerWin, contentWin, statusWin,
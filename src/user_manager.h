@@ -5,6 +5,8 @@
 #include <vector>
 #include <curses.h>
 
+class StatisticsManager;
+
 // 用户结构体
 struct User {
     std::string username;
@@ -19,15 +21,25 @@ private:
     User currentUser;
     std::string usersListFile;
     std::string userDir;
+    StatisticsManager* statsManager = nullptr;  // 重命名和删除用户文件前等待它的后台写入
     
     // 内部辅助函数
     void loadUsersList();
     void saveUsersList();
     bool createUserDirectory();
 
+    // 写完后台排队的统计和历史数据，避免排队的写入在文件改名或删除后重新创建旧文件
+    void flushStatistics();
+
+    // 统计管理器正在使用oldStatsFile时改用newStatsFile（为空表示不再保存）
+    void retargetStatistics(const std::string& oldStatsFile, const std::string& newStatsFile);
+
 public:
     UserManager(const std::string& userDirPath);
     ~UserManager();
+
+    // 设置统计管理器，重命名和删除用户时与它同步
+    void setStatisticsManager(StatisticsManager* manager) { statsManager = manager; }
     
     // 用户管理函数
     bool selectUser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin);
@@ -36,6 +48,9 @@ public:
     // 获取当前用户信息
     User getCurrentUser() const { return currentUser; }
     std::string getCurrentUserStatsPath() const;
+
+    // 用户的回放目录（重命名和删除用户时随统计文件一起处理）
+    std::string getReplayDir(const std::string& username) const;
     
     // 用户切换功能
     bool switchUser(WINDOW* headerWin, WINDOW* contentWin, WINDOW* statusWin);
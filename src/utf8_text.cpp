@@ -0,0 +1,222 @@
+#include "utf8_text.h"
+#include <cwctype>
+
+using namespace std;
+
+namespace Utf8
+{
+    static const char32_t REPLACEMENT_CHAR = 0xFFFD;
+
+    // 将UTF-8文本解码为码位序列
+    u32string decode(const string& text)
+    {
+        u32string result;
+        decodeAppend(text, result);
+        return result;
+    }
+
+    // 解码并追加
+    void decodeAppend(const string& text, u32string& result)
+    {
+        result.reserve(result.size() + text.size());
+
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+        const unsigned char* end = p + text.size();
+        while (p < end)
+        {
+            unsigned char lead = *p;
+
+            // ASCII快速路径
+            if (lead < 0x80)
+            {
+                result += static_cast<char32_t>(lead);
+                p++;
+                continue;
+            }
+
+            int extra;
+            char32_t ch;
+            char32_t minValue;
+            if ((lead & 0xE0) == 0xC0)
+            {
+                extra = 1;
+                ch = lead & 0x1F;
+                minValue = 0x80;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                extra = 2;
+                ch = lead & 0x0F;
+                minValue = 0x800;
+            }
+            else if ((lead & 0xF8) == 0xF0)
+            {
+                extra = 3;
+                ch = lead & 0x07;
+                minValue = 0x10000;
+            }
+            else
+            {
+                result += REPLACEMENT_CHAR;
+                p++;
+                continue;
+            }
+
+            if (end - p <= extra)
+            {
+                result += REPLACEMENT_CHAR;
+                break;
+            }
+
+            bool valid = true;
+            for (int i = 1; i <= extra; i++)
+            {
+                if ((p[i] & 0xC0) != 0x80)
+                {
+                    valid = false;
+                    break;
+                }
+                ch = (ch << 6) | (p[i] & 0x3F);
+            }
+
+            // 过长编码、代理区和超出范围的码位都视为非法
+            if (!valid || ch < minValue || ch > 0x10FFFF || (ch >= 0xD800 && ch <= 0xDFFF))
+            {
+                result += REPLACEMENT_CHAR;
+                p++;
+                continue;
+            }
+
+            result += ch;
+            p += extra + 1;
+        }
+    }
+
+    // 将码位编码为UTF-8并追加到out末尾
+    void append(string& out, char32_t ch)
+    {
+        if (ch < 0x80)
+        {
+            out += static_cast<char>(ch);
+        }
+        else if (ch < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (ch >> 6));
+            out += static_cast<char>(0x80 | (ch & 0x3F));
+        }
+        else if (ch < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (ch >> 12));
+            out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (ch & 0x3F));
+        }
+        else if (ch <= 0x10FFFF)
+        {
+            out += static_cast<char>(0xF0 | (ch >> 18));
+            out += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (ch & 0x3F));
+        }
+        else
+        {
+            append(out, REPLACEMENT_CHAR);
+        }
+    }
+
+    // 编码为UTF-8
+    string encode(char32_t ch)
+    {
+        string out;
+        append(out, ch);
+        return out;
+    }
+
+    string encode(const u32string& text)
+    {
+        return encode(text.data(), text.size());
+    }
+
+    string encode(const char32_t* text, size_t length)
+    {
+        string out;
+        out.reserve(length);
+        for (size_t i = 0; i < length; i++)
+        {
+            append(out, text[i]);
+        }
+        return out;
+    }
+
+    // 字符显示宽度
+    int displayWidth(char32_t ch)
+    {
+        if (ch < 0x1100)
+        {
+            return 1;
+        }
+
+        // 16位wchar_t无法表示的字符以U+FFFD显示，占1列
+        if (sizeof(wchar_t) < 4 && ch > 0xFFFF)
+        {
+            return 1;
+        }
+
+        // 东亚宽字符：谚文字母、中日韩部首到彝文、谚文音节、兼容汉字、竖排和全角符号、扩展汉字
+        if ((ch <= 0x115F) ||
+            (ch >= 0x2E80 && ch <= 0xA4CF && ch != 0x303F) ||
+            (ch >= 0xAC00 && ch <= 0xD7A3) ||
+            (ch >= 0xF900 && ch <= 0xFAFF) ||
+            (ch >= 0xFE30 && ch <= 0xFE4F) ||
+            (ch >= 0xFF00 && ch <= 0xFF60) ||
+            (ch >= 0xFFE0 && ch <= 0xFFE6) ||
+            (ch >= 0x1F300 && ch <= 0x1F64F) ||
+            (ch >= 0x20000 && ch <= 0x3FFFD))
+        {
+            return 2;
+        }
+        return 1;
+    }
+
+    // 转换为终端可显示的宽字符
+    wchar_t toDisplayChar(char32_t ch)
+    {
+        if (sizeof(wchar_t) < 4 && ch > 0xFFFF)
+        {
+            return static_cast<wchar_t>(REPLACEMENT_CHAR);
+        }
+        return static_cast<wchar_t>(ch);
+    }
+
+    // 截断或补齐到指定的显示列数
+    string fitColumns(const string& text, int columns)
+    {
+        string out;
+        int used = 0;
+        for (char32_t ch : decode(text))
+        {
+            int width = displayWidth(ch);
+            if (used + width > columns)
+            {
+                break;
+            }
+            append(out, ch);
+            used += width;
+        }
+        out.append(static_cast<size_t>(columns - used), ' ');
+        return out;
+    }
+
+    // 大小写折叠
+    char32_t foldCase(char32_t ch)
+    {
+        if (ch < 0x80)
+        {
+            return (ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+        }
+        if (ch <= 0xFFFF)
+        {
+            return static_cast<char32_t>(towlower(static_cast<wint_t>(ch)));
+        }
+        return ch;
+    }
+}
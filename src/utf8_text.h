@@ -0,0 +1,36 @@
+#ifndef UTF8_TEXT_H
+#define UTF8_TEXT_H
+
+#include <string>
+
+// UTF-8文本与UTF-32码位之间的转换，以及字符在终端中的显示宽度
+namespace Utf8
+{
+    // 将UTF-8文本解码为码位序列，非法字节替换为U+FFFD
+    std::u32string decode(const std::string& text);
+
+    // 解码并追加到out末尾（复用out已有的容量）
+    void decodeAppend(const std::string& text, std::u32string& out);
+
+    // 将码位编码为UTF-8并追加到out末尾
+    void append(std::string& out, char32_t ch);
+
+    // 编码为UTF-8
+    std::string encode(char32_t ch);
+    std::string encode(const std::u32string& text);
+    std::string encode(const char32_t* text, size_t length);
+
+    // 字符在终端中占用的列数（东亚宽字符为2，其余为1）
+    int displayWidth(char32_t ch);
+
+    // 转换为终端可显示的宽字符（wchar_t为16位的平台上，基本多文种平面之外的字符显示为U+FFFD）
+    wchar_t toDisplayChar(char32_t ch);
+
+    // 截断或用空格补齐到指定的显示列数（不会截断在多字节字符中间）
+    std::string fitColumns(const std::string& text, int columns);
+
+    // 大小写折叠（用于忽略大小写模式）
+    char32_t foldCase(char32_t ch);
+}
+
+#endif // UTF8_TEXT_H
@@ -0,0 +1,223 @@
+#include "word_index.h"
+#include <algorithm>
+#include <cctype>
+
+using namespace std;
+
+namespace
+{
+    const vector<uint32_t> EMPTY_LIST;
+    const size_t MIN_WORD_LENGTH = 2;
+    const size_t MAX_WORD_LENGTH = 12;
+
+    // 单词首尾的标点不计入单词
+    bool isWordChar(char ch)
+    {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '\'' || ch == '-';
+    }
+}
+
+// 清空索引
+void WordIndex::clear()
+{
+    wordText.clear();
+    wordOffsets.clear();
+    wordLengths.clear();
+    seen.clear();
+    charWords.clear();
+    bigramWords.clear();
+}
+
+// 从文本中提取单词
+void WordIndex::addText(const string& text)
+{
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos])))
+        {
+            pos++;
+        }
+        size_t start = pos;
+        while (pos < text.size() && !isspace(static_cast<unsigned char>(text[pos])))
+        {
+            pos++;
+        }
+
+        // 去掉首尾标点
+        size_t end = pos;
+        while (start < end && !isWordChar(text[start]))
+        {
+            start++;
+        }
+        while (end > start && !isWordChar(text[end - 1]))
+        {
+            end--;
+        }
+
+        size_t length = end - start;
+        if (length < MIN_WORD_LENGTH || length > MAX_WORD_LENGTH)
+        {
+            continue;
+        }
+
+        bool printable = true;
+        for (size_t i = start; i < end && printable; i++)
+        {
+            printable = (text[i] > 0x20 && text[i] < 0x7F);
+        }
+        if (!printable)
+        {
+            continue;
+        }
+
+        string word = text.substr(start, length);
+        if (seen.insert(word).second)
+        {
+            wordOffsets.push_back(static_cast<uint32_t>(wordText.size()));
+            wordLengths.push_back(static_cast<uint8_t>(length));
+            wordText += word;
+        }
+    }
+}
+
+// 建立倒排表：每个字符和双字母组合按在单词中出现的次数排序，次数相同时短单词优先
+void WordIndex::finalize()
+{
+    seen.clear();
+    charWords.assign(128, vector<uint32_t>());
+    bigramWords.clear();
+
+    for (uint32_t id = 0; id < wordOffsets.size(); id++)
+    {
+        const char* word = wordText.data() + wordOffsets[id];
+        size_t length = wordLengths[id];
+
+        for (size_t i = 0; i < length; i++)
+        {
+            vector<uint32_t>& list = charWords[static_cast<unsigned char>(word[i])];
+            if (list.empty() || list.back() != id)
+            {
+                list.push_back(id);
+            }
+
+            if (i + 1 < length)
+            {
+                uint16_t key = static_cast<uint16_t>((static_cast<unsigned char>(word[i]) << 8) | static_cast<unsigned char>(word[i + 1]));
+                vector<uint32_t>& pairs = bigramWords[key];
+                if (pairs.empty() || pairs.back() != id)
+                {
+                    pairs.push_back(id);
+                }
+            }
+        }
+    }
+
+    // 先计算每个候选单词的出现次数，再排序截断
+    vector<pair<int, uint32_t>> ranked;
+    auto rank = [&](vector<uint32_t>& list, auto count)
+    {
+        ranked.clear();
+        for (uint32_t id : list)
+        {
+            ranked.emplace_back(count(wordText.data() + wordOffsets[id], wordLengths[id]), id);
+        }
+        stable_sort(ranked.begin(), ranked.end(),
+                    [this](const pair<int, uint32_t>& a, const pair<int, uint32_t>& b)
+                    {
+                        if (a.first != b.first)
+                        {
+                            return a.first > b.first;
+                        }
+                        return wordLengths[a.second] < wordLengths[b.second];
+                    });
+
+        if (list.size() > MAX_CANDIDATES)
+        {
+            list.resize(MAX_CANDIDATES);
+        }
+        for (size_t i = 0; i < list.size(); i++)
+        {
+            list[i] = ranked[i].second;
+        }
+        list.shrink_to_fit();
+    };
+
+    for (size_t ch = 0; ch < charWords.size(); ch++)
+    {
+        rank(charWords[ch], [ch](const char* word, size_t length) { return countChar(word, length, static_cast<char>(ch)); });
+    }
+    for (auto& entry : bigramWords)
+    {
+        char first = static_cast<char>(entry.first >> 8);
+        char second = static_cast<char>(entry.first & 0xFF);
+        rank(entry.second, [first, second](const char* word, size_t length) { return countBigram(word, length, first, second); });
+    }
+}
+
+// 包含指定字符的单词
+const vector<uint32_t>& WordIndex::wordsWithChar(char ch) const
+{
+    unsigned char index = static_cast<unsigned char>(ch);
+    return (index < charWords.size()) ? charWords[index] : EMPTY_LIST;
+}
+
+// 包含指定双字母组合的单词
+const vector<uint32_t>& WordIndex::wordsWithBigram(char first, char second) const
+{
+    uint16_t key = static_cast<uint16_t>((static_cast<unsigned char>(first) << 8) | static_cast<unsigned char>(second));
+    auto it = bigramWords.find(key);
+    return (it != bigramWords.end()) ? it->second : EMPTY_LIST;
+}
+
+// 单词文本
+string WordIndex::getWord(uint32_t id) const
+{
+    return wordText.substr(wordOffsets[id], wordLengths[id]);
+}
+
+// 随机拼接候选单词，排名靠前（包含次数多）的单词被选中的概率更高
+string WordIndex::makeText(const vector<uint32_t>& candidates, size_t minChars, mt19937& rng) const
+{
+    string result;
+    if (candidates.empty())
+    {
+        return result;
+    }
+
+    // 取两次均匀随机数中较小的一个，使分布偏向列表前部
+    uniform_int_distribution<size_t> distrib(0, candidates.size() - 1);
+    uint32_t previous = static_cast<uint32_t>(-1);
+    while (result.size() < minChars)
+    {
+        uint32_t id = candidates[min(distrib(rng), distrib(rng))];
+        if (id == previous && candidates.size() > 1)
+        {
+            continue;
+        }
+        result += ' ';
+        result.append(wordText, wordOffsets[id], wordLengths[id]);
+        previous = id;
+    }
+    return result;
+}
+
+// 统计字符出现次数
+int WordIndex::countChar(const char* word, size_t length, char ch)
+{
+    return static_cast<int>(count(word, word + length, ch));
+}
+
+// 统计双字母组合出现次数
+int WordIndex::countBigram(const char* word, size_t length, char first, char second)
+{
+    int total = 0;
+    for (size_t i = 0; i + 1 < length; i++)
+    {
+        if (word[i] == first && word[i + 1] == second)
+        {
+            total++;
+        }
+    }
+    return total;
+}
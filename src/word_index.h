@@ -0,0 +1,56 @@
+#ifndef WORD_INDEX_H
+#define WORD_INDEX_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 单词索引：按字符和双字母组合查找包含它们的单词，用于生成针对薄弱环节的练习文本
+// 语料中的单词去重后连续存放在一个缓冲区中；finalize之后每个字符和双字母组合对应一个
+// 按出现次数从多到少排序的单词列表，练习中查询只是一次数组或哈希表访问
+class WordIndex
+{
+public:
+    // 每个字符或双字母组合最多保留的候选单词数
+    static const size_t MAX_CANDIDATES = 64;
+
+    // 清空索引
+    void clear();
+
+    // 从文本中提取单词（只收录由可打印ASCII字符组成、长度2~12的单词）
+    void addText(const std::string& text);
+
+    // 建立倒排表，之后才能查询
+    void finalize();
+
+    bool isEmpty() const { return wordOffsets.empty(); }
+    size_t getWordCount() const { return wordOffsets.size(); }
+
+    // 包含指定字符或双字母组合的单词编号
+    const std::vector<uint32_t>& wordsWithChar(char ch) const;
+    const std::vector<uint32_t>& wordsWithBigram(char first, char second) const;
+
+    // 单词文本
+    std::string getWord(uint32_t id) const;
+
+    // 从候选单词中随机挑选，拼接成至少minChars个字符的文本（每个单词前加一个空格）
+    std::string makeText(const std::vector<uint32_t>& candidates, size_t minChars, std::mt19937& rng) const;
+
+private:
+    // 统计word中ch出现的次数 / first、second相邻出现的次数
+    static int countChar(const char* word, size_t length, char ch);
+    static int countBigram(const char* word, size_t length, char first, char second);
+
+    std::string wordText;                   // 所有单词连续存放
+    std::vector<uint32_t> wordOffsets;      // 每个单词在wordText中的起始位置
+    std::vector<uint8_t> wordLengths;       // 每个单词的长度
+    std::unordered_set<std::string> seen;   // 建立索引时去重用，finalize后释放
+
+    std::vector<std::vector<uint32_t>> charWords;                  // 按ASCII码索引
+    std::unordered_map<uint16_t, std::vector<uint32_t>> bigramWords; // 按 first << 8 | second 索引
+};
+
+#endif // WORD_INDEX_H